@@ -0,0 +1,34 @@
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include <stdint.h>
+
+typedef struct {
+  const char *name;
+  /* Gets called after every reset, e.g. to (re-)initialize peripherals. May be NULL. */
+  void (*init)(void);
+  /* Executes one iteration of the workload. Returns a checksum of the result. */
+  uint32_t (*run)(void);
+  /* Number of iterations that make up one benchmark run */
+  unsigned int n_iterations;
+} bench_workload_t;
+
+extern const bench_workload_t bench_crc;
+extern const bench_workload_t bench_aes;
+extern const bench_workload_t bench_fft;
+extern const bench_workload_t bench_fft_chunked;
+extern const bench_workload_t bench_sort;
+extern const bench_workload_t bench_sense;
+extern const bench_workload_t bench_gnss;
+
+/* Simple xorshift PRNG used to generate deterministic input data */
+static inline uint32_t bench_rand(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+#endif /* __BENCH_H_ */
@@ -0,0 +1,106 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "riotee.h"
+
+#define FFT_LOG2N 8
+#define FFT_N (1 << FFT_LOG2N)
+
+typedef struct {
+  int16_t re;
+  int16_t im;
+} cq15_t;
+
+/* Transformed in place by run() and thus retained, so that a restored checkpoint finds the partial transform */
+static cq15_t fft_buf[FFT_N];
+/* Input is regenerated by init() after every reset and need not be retained */
+static int16_t fft_input[FFT_N] __VOLATILE_UNINITIALIZED;
+/* Twiddle factors exp(-j*2*pi*k/N) for k < N/2, computed for FFT_LOG2N 8 */
+static const cq15_t twiddle[FFT_N / 2] = {
+    {32767, 0}, {32757, -804}, {32727, -1607}, {32678, -2410}, {32609, -3211}, {32520, -4011},
+    {32412, -4807}, {32284, -5601}, {32137, -6392}, {31970, -7179}, {31785, -7961}, {31580, -8739},
+    {31356, -9511}, {31113, -10278}, {30851, -11038}, {30571, -11792}, {30272, -12539}, {29955, -13278},
+    {29621, -14009}, {29268, -14732}, {28897, -15446}, {28510, -16150}, {28105, -16845}, {27683, -17530},
+    {27244, -18204}, {26789, -18867}, {26318, -19519}, {25831, -20159}, {25329, -20787}, {24811, -21402},
+    {24278, -22004}, {23731, -22594}, {23169, -23169}, {22594, -23731}, {22004, -24278}, {21402, -24811},
+    {20787, -25329}, {20159, -25831}, {19519, -26318}, {18867, -26789}, {18204, -27244}, {17530, -27683},
+    {16845, -28105}, {16150, -28510}, {15446, -28897}, {14732, -29268}, {14009, -29621}, {13278, -29955},
+    {12539, -30272}, {11792, -30571}, {11038, -30851}, {10278, -31113}, {9511, -31356}, {8739, -31580},
+    {7961, -31785}, {7179, -31970}, {6392, -32137}, {5601, -32284}, {4807, -32412}, {4011, -32520},
+    {3211, -32609}, {2410, -32678}, {1607, -32727}, {804, -32757}, {0, -32767}, {-804, -32757},
+    {-1607, -32727}, {-2410, -32678}, {-3211, -32609}, {-4011, -32520}, {-4807, -32412}, {-5601, -32284},
+    {-6392, -32137}, {-7179, -31970}, {-7961, -31785}, {-8739, -31580}, {-9511, -31356}, {-10278, -31113},
+    {-11038, -30851}, {-11792, -30571}, {-12539, -30272}, {-13278, -29955}, {-14009, -29621}, {-14732, -29268},
+    {-15446, -28897}, {-16150, -28510}, {-16845, -28105}, {-17530, -27683}, {-18204, -27244}, {-18867, -26789},
+    {-19519, -26318}, {-20159, -25831}, {-20787, -25329}, {-21402, -24811}, {-22004, -24278}, {-22594, -23731},
+    {-23169, -23169}, {-23731, -22594}, {-24278, -22004}, {-24811, -21402}, {-25329, -20787}, {-25831, -20159},
+    {-26318, -19519}, {-26789, -18867}, {-27244, -18204}, {-27683, -17530}, {-28105, -16845}, {-28510, -16150},
+    {-28897, -15446}, {-29268, -14732}, {-29621, -14009}, {-29955, -13278}, {-30272, -12539}, {-30571, -11792},
+    {-30851, -11038}, {-31113, -10278}, {-31356, -9511}, {-31580, -8739}, {-31785, -7961}, {-31970, -7179},
+    {-32137, -6392}, {-32284, -5601}, {-32412, -4807}, {-32520, -4011}, {-32609, -3211}, {-32678, -2410},
+    {-32727, -1607}, {-32757, -804},
+};
+
+static void init(void) {
+  uint32_t seed = 0x5EED;
+
+  /* Two tones plus noise */
+  for (unsigned int i = 0; i < FFT_N; i++) {
+    fft_input[i] = (int16_t)(8000.0f * sinf(2.0f * (float)M_PI * 13 * i / FFT_N) +
+                             4000.0f * sinf(2.0f * (float)M_PI * 50 * i / FFT_N)) +
+                   (int16_t)(bench_rand(&seed) & 0x3FF);
+  }
+}
+
+/* In-place radix-2 decimation-in-time FFT. Scales by 1/2 in every stage to avoid overflow. */
+static void fft_q15(cq15_t *x) {
+  /* Bit reversal permutation */
+  for (unsigned int i = 1, j = 0; i < FFT_N; i++) {
+    unsigned int bit = FFT_N >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      cq15_t tmp = x[i];
+      x[i] = x[j];
+      x[j] = tmp;
+    }
+  }
+
+  for (unsigned int len = 2; len <= FFT_N; len <<= 1) {
+    unsigned int half = len >> 1;
+    unsigned int tw_step = FFT_N / len;
+    for (unsigned int i = 0; i < FFT_N; i += len) {
+      for (unsigned int k = 0; k < half; k++) {
+        cq15_t w = twiddle[k * tw_step];
+        cq15_t *a = &x[i + k];
+        cq15_t *b = &x[i + k + half];
+        int32_t tr = ((int32_t)b->re * w.re - (int32_t)b->im * w.im) >> 15;
+        int32_t ti = ((int32_t)b->re * w.im + (int32_t)b->im * w.re) >> 15;
+        b->re = (a->re - tr) >> 1;
+        b->im = (a->im - ti) >> 1;
+        a->re = (a->re + tr) >> 1;
+        a->im = (a->im + ti) >> 1;
+      }
+    }
+  }
+}
+
+static uint32_t run(void) {
+  uint32_t chk = 0;
+
+  for (unsigned int i = 0; i < FFT_N; i++) {
+    fft_buf[i].re = fft_input[i];
+    fft_buf[i].im = 0;
+  }
+
+  fft_q15(fft_buf);
+
+  for (unsigned int i = 0; i < FFT_N; i++)
+    chk += (uint32_t)(fft_buf[i].re * fft_buf[i].re + fft_buf[i].im * fft_buf[i].im);
+  return chk;
+}
+
+const bench_workload_t bench_fft = {.name = "fft", .init = init, .run = run, .n_iterations = 50};
@@ -0,0 +1,64 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "riotee.h"
+#include "riotee_dsp.h"
+
+/* 256 points keep the retained transform data at 1KB */
+#define FFT_LOG2N 8
+#define FFT_N (1 << FFT_LOG2N)
+/* Operations per iteration, one iteration is one chunk of the transform */
+#define FFT_CHUNK_OPS 64
+#define FFT_OPS (FFT_N + FFT_N / 2 * FFT_LOG2N)
+/* Number of complete transforms per benchmark run */
+#define FFT_N_TRANSFORMS 4
+
+/* Transform state and data are retained, so a transform continues after a reset */
+static riotee_fft_t fft;
+static int16_t fft_data[2 * FFT_N];
+static bool active;
+/* Twiddle factors are recomputed by init() after every reset and need not be retained */
+static int16_t twiddle[FFT_N] __VOLATILE_UNINITIALIZED;
+
+static void init(void) {
+  riotee_fft_twiddle_init(twiddle, FFT_LOG2N);
+}
+
+static void load_input(void) {
+  uint32_t seed = 0x5EED;
+
+  /* Two tones plus noise */
+  for (unsigned int i = 0; i < FFT_N; i++) {
+    fft_data[2 * i] = (int16_t)(8000.0f * sinf(2.0f * (float)M_PI * 13 * i / FFT_N) +
+                                4000.0f * sinf(2.0f * (float)M_PI * 50 * i / FFT_N)) +
+                      (int16_t)(bench_rand(&seed) & 0x3FF);
+    fft_data[2 * i + 1] = 0;
+  }
+}
+
+/* Computes one chunk of a 256 point FFT. Returns the checksum when a transform completes. */
+static uint32_t run(void) {
+  uint32_t chk = 0;
+
+  if (!active) {
+    load_input();
+    riotee_fft_init(&fft, fft_data, twiddle, FFT_LOG2N);
+    active = true;
+  }
+
+  if (!riotee_fft_step(&fft, FFT_CHUNK_OPS))
+    return 0;
+
+  active = false;
+  for (unsigned int i = 0; i < FFT_N; i++)
+    chk += (uint32_t)(fft_data[2 * i] * fft_data[2 * i] + fft_data[2 * i + 1] * fft_data[2 * i + 1]);
+  return chk;
+}
+
+const bench_workload_t bench_fft_chunked = {.name = "fft_chunked",
+                                            .init = init,
+                                            .run = run,
+                                            .n_iterations =
+                                                FFT_N_TRANSFORMS * ((FFT_OPS + FFT_CHUNK_OPS - 1) / FFT_CHUNK_OPS)};
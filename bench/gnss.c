@@ -0,0 +1,50 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "riotee.h"
+#include "riotee_spic.h"
+#include "riotee_spis.h"
+#include "max2769.h"
+#include "snapshot_handler.h"
+
+static const riotee_spic_cfg_t spic_cfg = {.mode = SPIC_MODE0_CPOL0_CPHA0,
+                                           .frequency = SPIC_FREQUENCY_K500,
+                                           .pin_cs = PIN_D8,
+                                           .pin_sck = PIN_D10,
+                                           .pin_copi = PIN_D9,
+                                           .pin_cipo = SPIC_PIN_UNUSED};
+
+static const riotee_spis_cfg_t spis_cfg = {.mode = SPIS_MODE1_CPOL0_CPHA1,
+                                           .pin_cs_out = PIN_D4,
+                                           .pin_cs_in = PIN_D5,
+                                           .pin_sck = PIN_D2,
+                                           .pin_mosi = PIN_D3};
+
+static const max2769_cfg_t max2769_cfg = {.snapshot_size_bytes = SNAPSHOT_SIZE_BYTES,
+                                          .sampling_frequency = MAX2769_SAMPLING_FREQUENCY_M4,
+                                          .adc_resolution = MAX2769_ADC_RESOLUTION_1B,
+                                          .min_power_option = MAX2769_MIN_POWER_OPTION_ENABLE,
+                                          .pin_pe = PIN_D7};
+
+static void init(void) {
+  spic_init(&spic_cfg);
+  spis_init(&spis_cfg);
+  max2769_init(&max2769_cfg);
+}
+
+/* Powers up the MAX2769 front-end, captures one GNSS snapshot via SPIS and powers the front-end down again */
+static uint32_t run(void) {
+  uint32_t chk = 0;
+
+  enable_max2769(&max2769_cfg);
+  configure_max2769(&max2769_cfg);
+  spis_receive(&spis_cfg, snapshot_buf, max2769_cfg.snapshot_size_bytes);
+  disable_max2769(&max2769_cfg);
+
+  for (unsigned int i = 0; i < max2769_cfg.snapshot_size_bytes; i++)
+    chk = (chk << 1 | chk >> 31) ^ snapshot_buf[i];
+  return chk;
+}
+
+const bench_workload_t bench_gnss = {.name = "gnss", .init = init, .run = run, .n_iterations = 5};
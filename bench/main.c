@@ -0,0 +1,152 @@
+#include "nrf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "printf.h"
+#include "riotee.h"
+#include "runtime.h"
+#include "riotee_thresholds.h"
+#include "riotee_timing.h"
+
+#include "bench.h"
+
+typedef struct {
+  const char *name;
+  thr_high_t thr_high;
+  thr_low_t thr_low;
+} bench_profile_t;
+
+typedef struct {
+  /* Iterations that were executed */
+  unsigned int n_iterations;
+  /* Iterations that were not interrupted by a turnoff or reset */
+  unsigned int n_clean;
+  uint32_t cycles_min;
+  uint32_t cycles_max;
+  uint64_t cycles_sum;
+  /* Number of resets survived while running the workload */
+  unsigned int n_reset;
+  /* Number of checkpoints and bytes written to NVM while running the workload */
+  unsigned int n_checkpoint;
+  unsigned int checkpoint_bytes;
+  /* Time until completion in 32kHz ticks, not counting the time the device was off */
+  unsigned int ticks;
+  uint32_t checksum;
+} bench_result_t;
+
+/* The energy available per on-period is set by the capacitor voltage thresholds. A narrow window between high and
+ * low threshold emulates a weak harvesting source that only allows short bursts of execution. */
+static const bench_profile_t profiles[] = {
+    {.name = "wide", .thr_high = THR_HIGH_4V6, .thr_low = THR_LOW_3V1},
+    {.name = "medium", .thr_high = THR_HIGH_4V0, .thr_low = THR_LOW_3V1},
+    {.name = "narrow", .thr_high = THR_HIGH_3V6, .thr_low = THR_LOW_3V1},
+};
+
+static const bench_workload_t *workloads[] = {&bench_crc,  &bench_aes,   &bench_fft,  &bench_fft_chunked,
+                                              &bench_sort, &bench_sense, &bench_gnss};
+
+#define N_PROFILES (sizeof(profiles) / sizeof(profiles[0]))
+#define N_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+/* Results live in retained memory and thus survive resets */
+static bench_result_t results[N_PROFILES][N_WORKLOADS];
+
+static void cycle_counter_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static void run_workload(const bench_workload_t *wl, bench_result_t *res) {
+  unsigned int n_reset = runtime_stats.n_reset;
+  unsigned int n_turnoff = runtime_stats.n_turnoff;
+  unsigned int n_checkpoint = runtime_stats.n_checkpoint;
+  unsigned int checkpoint_bytes = runtime_stats.checkpoint_bytes;
+  unsigned int n_reset_start = n_reset;
+  unsigned int last_tick = NRF_RTC0->COUNTER;
+
+  res->cycles_min = UINT32_MAX;
+
+  for (res->n_iterations = 0; res->n_iterations < wl->n_iterations; res->n_iterations++) {
+    uint32_t start = DWT->CYCCNT;
+    res->checksum ^= wl->run();
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    if (runtime_stats.n_reset != n_reset) {
+      /* Execution was restored from a checkpoint. RTC and cycle counter were restarted in the meantime. */
+      n_reset = runtime_stats.n_reset;
+      n_turnoff = runtime_stats.n_turnoff;
+      res->ticks += NRF_RTC0->COUNTER;
+      last_tick = NRF_RTC0->COUNTER;
+      continue;
+    }
+
+    res->ticks += (NRF_RTC0->COUNTER - last_tick) % (1 << 24);
+    last_tick = NRF_RTC0->COUNTER;
+
+    /* Measurement includes runtime overhead for teardown and recovery */
+    if (runtime_stats.n_turnoff != n_turnoff) {
+      n_turnoff = runtime_stats.n_turnoff;
+      continue;
+    }
+
+    res->n_clean++;
+    res->cycles_sum += cycles;
+    if (cycles < res->cycles_min)
+      res->cycles_min = cycles;
+    if (cycles > res->cycles_max)
+      res->cycles_max = cycles;
+  }
+
+  res->n_reset = runtime_stats.n_reset - n_reset_start;
+  res->n_checkpoint = runtime_stats.n_checkpoint - n_checkpoint;
+  res->checkpoint_bytes = runtime_stats.checkpoint_bytes - checkpoint_bytes;
+}
+
+static void print_result(const bench_profile_t *profile, const bench_workload_t *wl, bench_result_t *res) {
+  unsigned int cycles_avg = res->n_clean ? (unsigned int)(res->cycles_sum / res->n_clean) : 0;
+
+  printf("BENCH %s %s iter=%u clean=%u cyc_min=%u cyc_avg=%u cyc_max=%u resets=%u ckpts=%u ckpt_bytes=%u ticks=%u "
+         "chk=%08X\r\n",
+         profile->name, wl->name, res->n_iterations, res->n_clean, res->n_clean ? res->cycles_min : 0, cycles_avg,
+         res->cycles_max, res->n_reset, res->n_checkpoint, res->checkpoint_bytes, res->ticks, res->checksum);
+}
+
+/* This gets called one time after flashing new firmware */
+void bootstrap_callback(void) {
+  printf("BENCH start\r\n");
+}
+
+/* This gets called after every reset */
+void reset_callback(void) {
+  cycle_counter_init();
+
+  for (unsigned int w = 0; w < N_WORKLOADS; w++) {
+    if (workloads[w]->init != NULL)
+      workloads[w]->init();
+  }
+}
+
+void user_task(void *pvParameter) {
+  UNUSED_PARAMETER(pvParameter);
+
+  for (unsigned int p = 0; p < N_PROFILES; p++) {
+    riotee_thresholds_high_set(profiles[p].thr_high);
+    riotee_thresholds_low_set(profiles[p].thr_low);
+
+    for (unsigned int w = 0; w < N_WORKLOADS; w++) {
+      wait_until_charged();
+      run_workload(workloads[w], &results[p][w]);
+      print_result(&profiles[p], workloads[w], &results[p][w]);
+    }
+  }
+
+  /* Restore the default thresholds from startup */
+  riotee_thresholds_high_set(THR_HIGH_4V6);
+  riotee_thresholds_low_set(THR_LOW_3V1);
+  printf("BENCH done\r\n");
+
+  for (;;) {
+    riotee_sleep_ms(1000);
+  }
+}
@@ -0,0 +1,51 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "riotee_adc.h"
+#include "riotee_ble.h"
+
+#define SENSE_N_SAMPLES 16
+
+static riotee_ble_ll_addr_t adv_address = {.addr_bytes = {0xBE, 0xEF, 0xDE, 0xAD, 0x00, 0x02}};
+
+static int16_t samples[SENSE_N_SAMPLES];
+
+static struct {
+  uint32_t seq;
+  int16_t avg;
+} __attribute__((packed)) adv_data;
+
+static void init(void) {
+  riotee_adc_init();
+  riotee_ble_init();
+  riotee_ble_prepare_adv(&adv_address, "BENCH", 5, sizeof(adv_data));
+}
+
+/* Samples A0 at 1kHz, averages the samples and advertises the result on all three channels */
+static uint32_t run(void) {
+  riotee_adc_cfg_t cfg = {.gain = RIOTEE_ADC_GAIN1_4,
+                          .reference = RIOTEE_ADC_REFERENCE_VDD4,
+                          .acq_time = RIOTEE_ADC_ACQTIME_10US,
+                          .input_pos = RIOTEE_ADC_INPUT_A0,
+                          .input_neg = RIOTEE_ADC_INPUT_NC,
+                          .oversampling = RIOTEE_ADC_OVERSAMPLE_DISABLED,
+                          .n_samples = SENSE_N_SAMPLES,
+                          .sample_interval_ticks32 = 33};
+  int32_t sum = 0;
+
+  if (riotee_adc_sample(samples, &cfg) != 0)
+    return 0;
+
+  for (unsigned int i = 0; i < SENSE_N_SAMPLES; i++)
+    sum += samples[i];
+
+  adv_data.avg = sum / SENSE_N_SAMPLES;
+  adv_data.seq++;
+
+  if (riotee_ble_advertise(&adv_data, ADV_CH_ALL) != 0)
+    return 0;
+  return adv_data.seq;
+}
+
+const bench_workload_t bench_sense = {.name = "sense", .init = init, .run = run, .n_iterations = 20};
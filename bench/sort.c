@@ -0,0 +1,40 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+#define SORT_N 512
+
+/* Sorted in place by run() and thus retained, so that a restored checkpoint finds the partially sorted data */
+static uint16_t sort_buf[SORT_N];
+static uint32_t seed = 0xBADC0DE;
+
+/* Shell sort with Ciura's gap sequence: in-place and without recursion */
+static void shell_sort(uint16_t *arr, unsigned int n) {
+  static const unsigned int gaps[] = {301, 132, 57, 23, 10, 4, 1};
+  for (unsigned int g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++) {
+    unsigned int gap = gaps[g];
+    for (unsigned int i = gap; i < n; i++) {
+      uint16_t tmp = arr[i];
+      unsigned int j;
+      for (j = i; (j >= gap) && (arr[j - gap] > tmp); j -= gap)
+        arr[j] = arr[j - gap];
+      arr[j] = tmp;
+    }
+  }
+}
+
+static uint32_t run(void) {
+  uint32_t chk = 0;
+
+  for (unsigned int i = 0; i < SORT_N; i++)
+    sort_buf[i] = bench_rand(&seed);
+
+  shell_sort(sort_buf, SORT_N);
+
+  for (unsigned int i = 0; i < SORT_N; i++)
+    chk = (chk * 31) + sort_buf[i];
+  return chk;
+}
+
+const bench_workload_t bench_sort = {.name = "sort", .init = NULL, .run = run, .n_iterations = 50};
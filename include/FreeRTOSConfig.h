@@ -8,9 +8,9 @@
 
 #define configUSE_PREEMPTION 1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
-#define configUSE_TICKLESS_IDLE 0
+#define configUSE_TICKLESS_IDLE 1
 #define configCPU_CLOCK_HZ 64000000
-#define configTICK_RATE_HZ 250
+#define configTICK_RATE_HZ 1024
 #define configMAX_PRIORITIES 5
 #define configMINIMAL_STACK_SIZE 128
 #define configMAX_TASK_NAME_LEN 16
@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef enum {
   RIOTEE_ADC_INPUT_NC = 0,
   RIOTEE_ADC_INPUT_VCAP = 6,
@@ -65,11 +69,82 @@ typedef struct {
   unsigned int sample_interval_ticks32;
 } riotee_adc_cfg_t;
 
+/* Configuration of a single channel in scan mode */
+typedef struct {
+  riotee_adc_gain_t gain;
+  riotee_adc_reference_t reference;
+  riotee_adc_acqtime_t acq_time;
+  riotee_adc_input_t input_pos;
+  riotee_adc_input_t input_neg;
+} riotee_adc_ch_cfg_t;
+
+typedef struct {
+  riotee_adc_ch_cfg_t *channels;
+  unsigned int n_channels;
+  /* Number of scans, every scan samples all channels once */
+  unsigned int n_samples;
+  unsigned int sample_interval_ticks32;
+} riotee_adc_scan_cfg_t;
+
+typedef struct {
+  /* Number of samples that are already in the buffer, including missing ones */
+  unsigned int n_done;
+  /* Number of times the acquisition was interrupted by a teardown or reset */
+  unsigned int n_resumed;
+  /* Number of samples that were set to RIOTEE_ADC_SAMPLE_MISSING */
+  unsigned int n_missing;
+  /* riotee_time_now() at the first sample, all later samples are taken on the same grid */
+  uint64_t t_start;
+} riotee_adc_progress_t;
+
+typedef enum { RIOTEE_ADC_LIMIT_NONE = 0, RIOTEE_ADC_LIMIT_LOW, RIOTEE_ADC_LIMIT_HIGH } riotee_adc_limit_t;
+
+enum { ADC_ERR_OK = 0, ADC_ERR_GENERIC = -1, ADC_ERR_BUSY = -2, ADC_ERR_OVERRUN = -3 };
+
+/* Maximum number of samples per buffer that EasyDMA can handle */
+#define RIOTEE_ADC_MAX_SAMPLES 32767
+/* Marks samples of riotee_adc_sample_resumable() that were not taken. The SAADC never returns this value. */
+#define RIOTEE_ADC_SAMPLE_MISSING INT16_MIN
+/* Number of SAADC channels that can be scanned */
+#define RIOTEE_ADC_MAX_CHANNELS 8
+
 int riotee_adc_init(void);
 
-/* Samples ADC into provided buffer. */
+/* Samples ADC into provided buffer. The first sample is taken immediately and the remaining n_samples - 1 samples every
+ * sample_interval_ticks32 ticks of the 32768Hz clock, triggered by RTC2 via PPI. The CPU only wakes up when the
+ * buffer is full. */
 int riotee_adc_sample(int16_t *dst, riotee_adc_cfg_t *cfg);
 
+/* Like riotee_adc_sample(), but an acquisition that is interrupted by a teardown or reset continues at the next sample
+ * instead of starting over. progress must be zero-initialized and must be a global variable, so that it is retained.
+ * dst[k] is always taken at t_start + k * sample_interval_ticks32. Samples whose time passed while the device was off
+ * are set to RIOTEE_ADC_SAMPLE_MISSING. */
+int riotee_adc_sample_resumable(int16_t *dst, riotee_adc_cfg_t *cfg, riotee_adc_progress_t *progress);
+
+/* Samples all channels in cfg->channels with every trigger. dst receives n_samples * n_channels results, interleaved
+ * by channel, i.e. dst[i * n_channels + ch]. Timing is the same as for riotee_adc_sample(). Oversampling is not
+ * supported in scan mode. */
+int riotee_adc_scan(int16_t *dst, riotee_adc_scan_cfg_t *cfg);
+
+/* Starts continuous sampling every cfg->sample_interval_ticks32 ticks into two alternating buffers of block_size
+ * samples each. cfg->n_samples is ignored. */
+int riotee_adc_stream_start(int16_t *buf0, int16_t *buf1, unsigned int block_size, riotee_adc_cfg_t *cfg);
+
+/* Waits until the next block is full and returns a pointer to it. The block must be processed before the following
+ * block is full, otherwise the next call returns ADC_ERR_OVERRUN and continues with the latest block. */
+int riotee_adc_stream_wait(int16_t **block);
+
+int riotee_adc_stream_stop(void);
+
+/* Starts sampling every cfg->sample_interval_ticks32 ticks in the background without waking up the CPU. Monitoring
+ * stops as soon as a sample falls below limit_low or rises above limit_high. Limits are in binary ADC units. */
+int riotee_adc_monitor_start(riotee_adc_cfg_t *cfg, int16_t limit_low, int16_t limit_high);
+
+/* Waits until a limit was crossed. limit receives the crossed limit and, if not NULL, value the last sample. */
+int riotee_adc_monitor_wait(riotee_adc_limit_t *limit, int16_t *value);
+
+int riotee_adc_monitor_stop(void);
+
 /* Reads a single ADC sample. */
 static inline int riotee_adc_read(float *dst, riotee_adc_input_t input) {
   int16_t adc_res;
@@ -91,10 +166,35 @@ static inline int riotee_adc_read(float *dst, riotee_adc_input_t input) {
 /* Converts binary ADC result to voltage. */
 float riotee_adc_adc2vadc(int16_t adc, riotee_adc_cfg_t *cfg);
 
+/* Converts binary ADC result of a channel in scan mode to voltage. */
+float riotee_adc_ch_adc2vadc(int16_t adc, riotee_adc_ch_cfg_t *cfg);
+
+/* Conversion factors for a channel configuration, see riotee_adc_scale_init() */
+typedef struct {
+  float volts_per_lsb;
+  /* Millivolts per LSB in Q14 */
+  int16_t mv_per_lsb_q14;
+} riotee_adc_scale_t;
+
+/* Precomputes the conversion factors for buffers that were sampled with cfg */
+void riotee_adc_scale_init(riotee_adc_scale_t *scale, riotee_adc_cfg_t *cfg);
+void riotee_adc_ch_scale_init(riotee_adc_scale_t *scale, riotee_adc_ch_cfg_t *cfg);
+
+/* Converts n binary ADC results to millivolts, two samples at a time with the SIMD instructions of the Cortex-M4. dst
+ * may be the same as src. */
+void riotee_adc_to_mv(int16_t *dst, const int16_t *src, unsigned int n, const riotee_adc_scale_t *scale);
+
+/* Converts n binary ADC results to volts */
+void riotee_adc_to_volts(float *dst, const int16_t *src, unsigned int n, const riotee_adc_scale_t *scale);
+
 /* Converts ADC voltage to capacitor voltage based on amplifier gain. */
 static inline float riotee_adc_vadc2vcap(float v_adc) {
   /* A capacitor voltage of 4.8V produces 1.727V on the ADC input */
   return v_adc / 1.727f * 4.8f;
 }
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -203,6 +203,8 @@ int am1805_init(void);
 int am1805_get_hundredths(unsigned int* hundredths);
 int am1805_set_datetime(struct tm* t);
 int am1805_get_datetime(struct tm* t);
+/* Reads the current time as hundredths of a second since 2000-01-01 00:00:00 (24 hour mode) */
+int am1805_get_timestamp(uint64_t* hundredths);
 
 int am1805_set_alarm(struct tm* t_alarm);
 int am1805_get_alarm(struct tm* t);
@@ -0,0 +1,111 @@
+#ifndef __RIOTEE_DSP_H_
+#define __RIOTEE_DSP_H_
+
+/* Streaming fixed-point filters for int16 sample buffers, e.g. from riotee_adc_sample().
+ *
+ * Filters process one block at a time and keep their history between calls, so consecutive blocks are filtered as one
+ * continuous signal. All filter state is owned by the caller. When filters and their state buffers are global
+ * variables, they are retained and filtering continues seamlessly after a reset.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum { DSP_ERR_OK = 0, DSP_ERR_GENERIC = -1 };
+
+typedef struct {
+  /* Q15 coefficients, coeffs[0] is applied to the newest sample */
+  const int16_t *coeffs;
+  /* History of 2 * n_taps samples, every sample is stored twice so the window is always contiguous */
+  int16_t *state;
+  unsigned int n_taps;
+  /* Only every decimation-th output is produced */
+  unsigned int decimation;
+  /* Position of the newest sample in state */
+  unsigned int pos;
+  /* Number of inputs since the last output */
+  unsigned int phase;
+} riotee_fir_t;
+
+/* Sets up an FIR filter with n_taps Q15 coefficients. state must hold 2 * n_taps samples. A decimation of 1 produces
+ * one output per input. */
+int riotee_fir_init(riotee_fir_t *fir, const int16_t *coeffs, unsigned int n_taps, int16_t *state,
+                    unsigned int decimation);
+
+/* Clears the history */
+void riotee_fir_reset(riotee_fir_t *fir);
+
+/* Filters n samples from src into dst and returns the number of outputs. dst may be the same as src. */
+unsigned int riotee_fir_process(riotee_fir_t *fir, int16_t *dst, const int16_t *src, unsigned int n);
+
+/* Q14 coefficients of a biquad with transfer function (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) */
+typedef struct {
+  int16_t b0, b1, b2, a1, a2;
+} riotee_biquad_coeffs_t;
+
+typedef struct {
+  /* Coefficients packed in pairs for dual 16-bit multiply-accumulate */
+  uint32_t b0_b1;
+  uint32_t b2_na1;
+  uint32_t na2;
+  int16_t x1, x2, y1, y2;
+} riotee_biquad_t;
+
+typedef struct {
+  riotee_biquad_t *stages;
+  unsigned int n_stages;
+} riotee_iir_t;
+
+/* Sets up a cascade of n_stages biquads (direct form I). stages must hold n_stages elements. Fails if a1 or a2 of any
+ * stage is -32768 (-2.0), as the feedback coefficients are stored negated. */
+int riotee_iir_init(riotee_iir_t *iir, riotee_biquad_t *stages, const riotee_biquad_coeffs_t *coeffs,
+                    unsigned int n_stages);
+
+/* Clears the history */
+void riotee_iir_reset(riotee_iir_t *iir);
+
+/* Filters n samples from src into dst. dst may be the same as src. */
+void riotee_iir_process(riotee_iir_t *iir, int16_t *dst, const int16_t *src, unsigned int n);
+
+/* Largest supported FFT size */
+#define RIOTEE_FFT_MAX_LOG2N 12
+
+/* In-place radix-2 FFT over interleaved Q15 complex data that is computed in chunks.
+ *
+ * The transform consists of a bit reversal and log2n butterfly stages. Every call to riotee_fft_step() performs a
+ * limited number of operations and records the progress in the struct, so a large transform can be spread over
+ * multiple charge cycles. When the struct and the data are global variables, they are retained and the transform
+ * continues where it left off after a reset.
+ */
+typedef struct {
+  /* n complex values, real and imaginary part interleaved */
+  int16_t *data;
+  /* n/2 complex twiddle factors exp(-j*2*pi*k/n), see riotee_fft_twiddle_init() */
+  const int16_t *twiddle;
+  unsigned int log2n;
+  /* 0 during bit reversal, 1..log2n for the butterfly stages and log2n + 1 when done */
+  unsigned int stage;
+  /* Next operation in the current stage */
+  unsigned int index;
+} riotee_fft_t;
+
+/* Computes the twiddle factors for an FFT of size 2^log2n into twiddle, which must hold 2^log2n values */
+void riotee_fft_twiddle_init(int16_t *twiddle, unsigned int log2n);
+
+/* Prepares a transform of the 2^log2n complex values in data. Every stage scales by 1/2, so the result is the DFT
+ * divided by n. Complex input values must have a magnitude of less than 1. */
+int riotee_fft_init(riotee_fft_t *fft, int16_t *data, const int16_t *twiddle, unsigned int log2n);
+
+/* Performs up to max_ops operations (element swaps or butterflies). Returns true when the transform is complete. A
+ * complete transform of size n takes n + n/2 * log2n operations. */
+bool riotee_fft_step(riotee_fft_t *fft, unsigned int max_ops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_DSP_H_ */
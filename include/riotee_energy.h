@@ -0,0 +1,79 @@
+#ifndef __RIOTEE_ENERGY_H_
+#define __RIOTEE_ENERGY_H_
+
+/* Empirical energy profiler.
+ *
+ * Samples the capacitor voltage before and after an operation and converts the voltage drop into energy with
+ * E = C/2 * (V_start^2 - V_end^2). Results are accumulated per name in a table in retained memory. Energy harvested
+ * while the operation runs is not visible to the profiler, so results are only meaningful with little or no input
+ * power. Measurements that are interrupted by a turnoff or reset are discarded.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default capacitance of the energy store */
+#ifndef RIOTEE_ENERGY_CAP_UF
+#define RIOTEE_ENERGY_CAP_UF 47.0f
+#endif
+
+/* Maximum number of distinct names in the table */
+#define RIOTEE_ENERGY_N_ENTRIES 16
+
+typedef struct {
+  /* Must point to a constant string, it is retained across resets */
+  const char *name;
+  unsigned int n_calls;
+  /* Measurements that were discarded because the device turned off in between */
+  unsigned int n_discarded;
+  float energy_sum_uj;
+  float energy_min_uj;
+  float energy_max_uj;
+} riotee_energy_entry_t;
+
+typedef struct {
+  float v_start;
+  unsigned int n_turnoff;
+  unsigned int n_reset;
+} riotee_energy_meas_t;
+
+enum { ENERGY_ERR_OK = 0, ENERGY_ERR_GENERIC = -1, ENERGY_ERR_DISCARDED = -2, ENERGY_ERR_FULL = -3 };
+
+/* Sets the capacitance used for converting voltage to energy */
+void riotee_energy_set_capacitance(float cap_uf);
+
+/* Samples the capacitor voltage at the start of an operation */
+int riotee_energy_start(riotee_energy_meas_t *meas);
+
+/* Samples the capacitor voltage at the end of an operation and adds the result to the entry for name. If energy_uj is
+ * not NULL, it receives the energy of this measurement. */
+int riotee_energy_stop(riotee_energy_meas_t *meas, const char *name, float *energy_uj);
+
+/* Returns the table entry for name or NULL if there is none */
+const riotee_energy_entry_t *riotee_energy_get(const char *name);
+
+/* Returns the table entry at idx or NULL if the entry is not used */
+const riotee_energy_entry_t *riotee_energy_get_idx(unsigned int idx);
+
+void riotee_energy_reset(void);
+
+/* Prints one line per entry: ENERGY <name> n= discarded= min_uj= avg_uj= max_uj= */
+void riotee_energy_dump(void);
+
+/* Measures the energy of a single statement, e.g. RIOTEE_ENERGY_PROFILE("adv", riotee_ble_advertise(&data, ch)); */
+#define RIOTEE_ENERGY_PROFILE(name, op)                \
+  do {                                                 \
+    riotee_energy_meas_t __energy_meas;                \
+    riotee_energy_start(&__energy_meas);               \
+    op;                                                \
+    riotee_energy_stop(&__energy_meas, (name), NULL);  \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_ENERGY_H_ */
@@ -0,0 +1,68 @@
+#ifndef __RIOTEE_GATE_H_
+#define __RIOTEE_GATE_H_
+
+/* Change detection that decides whether a reading needs to be transmitted.
+ *
+ * A reading passes the gate if it is the first one, if it moved further than the deadband away from the last reading
+ * that passed, if it changed faster than the maximum rate since the previous reading, or if the heartbeat interval
+ * expired since the last reading that passed. Every policy can be disabled separately, see riotee_gate_cfg_t. Times
+ * are taken from riotee_time_now(). Intervals only include the time the device was off if the AM1805 is used with
+ * riotee_time_use_am1805(true), otherwise the rate and heartbeat only see the time the device was running.
+ *
+ * All history is kept in the caller's struct. When the gate is a global variable, it is retained and decisions after a
+ * reset take the readings from before the reset into account.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  /* A reading passes if it differs from the last passed reading by more than this. 0 passes every change, INFINITY
+   * disables the deadband. */
+  float deadband;
+  /* A reading passes if it changed faster than this many units per second since the previous reading. 0 disables. */
+  float max_rate_per_s;
+  /* A reading passes if the last passed reading is at least this many 32768Hz ticks old. 0 disables. */
+  uint32_t heartbeat_ticks;
+} riotee_gate_cfg_t;
+
+typedef struct {
+  riotee_gate_cfg_t cfg;
+  /* Last reading that passed the gate and its time */
+  float last_passed;
+  uint64_t t_passed;
+  /* Previous reading, whether it passed or not, and its time */
+  float prev;
+  uint64_t t_prev;
+  bool has_passed;
+  unsigned int n_passed;
+  unsigned int n_suppressed;
+} riotee_gate_t;
+
+typedef enum {
+  RIOTEE_GATE_SUPPRESS = 0,
+  RIOTEE_GATE_FIRST,
+  RIOTEE_GATE_DEADBAND,
+  RIOTEE_GATE_RATE,
+  RIOTEE_GATE_HEARTBEAT,
+} riotee_gate_result_t;
+
+/* A zero-initialized gate with cfg set is ready to use, e.g. riotee_gate_t gate = {.cfg = {.deadband = 0.5f}}; */
+void riotee_gate_init(riotee_gate_t *gate, const riotee_gate_cfg_t *cfg);
+
+/* Lets the next reading pass, e.g. after a transmission failed */
+void riotee_gate_reset(riotee_gate_t *gate);
+
+/* Returns the reason why value needs to be transmitted or RIOTEE_GATE_SUPPRESS. A value that passes becomes the new
+ * reference for the deadband and heartbeat. */
+riotee_gate_result_t riotee_gate_check(riotee_gate_t *gate, float value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_GATE_H_ */
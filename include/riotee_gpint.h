@@ -19,6 +19,8 @@ extern "C" {
 #endif
 
 int riotee_gpint_init(void);
+/* Calls cb once from interrupt context when pin reaches level. pin is the absolute pin number, i.e. pins on P1 start at
+ * 32. The pin is unregistered before cb is called. */
 int riotee_gpint_register(uint32_t pin, gpint_level_t level, riotee_gpio_pin_pull_t pull, GPINT_CALLBACK cb);
 int riotee_gpint_unregister(uint32_t pin);
 int riotee_gpint_wait(uint32_t pin, gpint_level_t level, riotee_gpio_pin_pull_t pull);
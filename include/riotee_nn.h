@@ -0,0 +1,110 @@
+#ifndef __RIOTEE_NN_H_
+#define __RIOTEE_NN_H_
+
+/* Int8 quantized neural network inference.
+ *
+ * Activations are int8 in HWC layout with a zero point per layer. Weights are symmetric int8 and biases int32.
+ * Accumulators are requantized to int8 with a fixed-point multiplier and shift, as produced by the usual post-training
+ * quantization tools.
+ *
+ * The executor runs a network in tiles (one output row of a convolution or pooling layer or RIOTEE_NN_DENSE_TILE
+ * outputs of a dense layer) and records its progress after every tile. When the executor and its buffers are global
+ * variables, they are retained and inference continues after a reset instead of starting over.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of outputs of a dense layer per tile */
+#define RIOTEE_NN_DENSE_TILE 16
+
+enum { NN_ERR_OK = 0, NN_ERR_GENERIC = -1 };
+
+typedef enum { RIOTEE_NN_CONV2D = 0, RIOTEE_NN_DENSE, RIOTEE_NN_MAXPOOL2D, RIOTEE_NN_AVGPOOL2D } riotee_nn_op_t;
+
+typedef struct {
+  uint16_t h;
+  uint16_t w;
+  uint16_t c;
+} riotee_nn_shape_t;
+
+typedef struct {
+  riotee_nn_op_t op;
+  /* Dense layers use the flattened input and only out.c */
+  riotee_nn_shape_t in;
+  riotee_nn_shape_t out;
+  /* Convolution and pooling window */
+  uint8_t kernel_h;
+  uint8_t kernel_w;
+  uint8_t stride;
+  /* Zero padding on each side, convolution only */
+  uint8_t pad;
+  /* Convolution: [out.c][kernel_h][kernel_w][in.c], dense: [out.c][in.h * in.w * in.c] */
+  const int8_t *weights;
+  /* One per output channel */
+  const int32_t *bias;
+  /* Negated zero point of the input */
+  int32_t in_offset;
+  /* Zero point of the output */
+  int32_t out_offset;
+  /* Requantization: out = acc * multiplier / 2^(31 + shift), see riotee_nn_quantize_scale() */
+  int32_t multiplier;
+  int32_t shift;
+  /* Output clamp of all layer types, e.g. out_offset and 127 for a fused ReLU or -128 and 127 for none */
+  int32_t act_min;
+  int32_t act_max;
+} riotee_nn_layer_t;
+
+typedef struct {
+  const riotee_nn_layer_t *layers;
+  unsigned int n_layers;
+  /* Layers alternate between the two buffers, each must hold the largest activation */
+  int8_t *buf[2];
+  /* Next layer and tile */
+  unsigned int layer;
+  unsigned int tile;
+} riotee_nn_t;
+
+/* Converts a real-valued requantization scale (input scale * weight scale / output scale) to multiplier and shift */
+void riotee_nn_quantize_scale(float scale, int32_t *multiplier, int32_t *shift);
+
+/* Kernels. Convolution, pooling and dense layers compute output rows [row_start, row_end) or, for dense layers,
+ * outputs [row_start, row_end). */
+void riotee_nn_conv2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                      unsigned int row_end);
+void riotee_nn_dense(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                     unsigned int row_end);
+void riotee_nn_maxpool2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                         unsigned int row_end);
+void riotee_nn_avgpool2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                         unsigned int row_end);
+
+int riotee_nn_init(riotee_nn_t *nn, const riotee_nn_layer_t *layers, unsigned int n_layers, int8_t *buf0,
+                   int8_t *buf1);
+
+/* Restarts inference. The input must be in riotee_nn_input() before the first step. */
+void riotee_nn_start(riotee_nn_t *nn);
+
+static inline int8_t *riotee_nn_input(riotee_nn_t *nn) {
+  return nn->buf[0];
+}
+
+/* Computes up to max_tiles tiles. Returns true when the last layer is complete. */
+bool riotee_nn_step(riotee_nn_t *nn, unsigned int max_tiles);
+
+static inline const int8_t *riotee_nn_output(riotee_nn_t *nn) {
+  return nn->buf[nn->n_layers % 2];
+}
+
+/* Returns the index of the largest value, e.g. the class label of a classifier output */
+unsigned int riotee_nn_argmax(const int8_t *x, unsigned int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_NN_H_ */
@@ -6,6 +6,10 @@
 
 #include "nrf.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 enum { NVM_WRITE = 0x800000, NVM_READ = 0x0 };
 typedef uint32_t nvm_transfer_type_t;
 
@@ -15,4 +19,8 @@ int nvm_write(uint8_t *src, size_t size);
 int nvm_read(uint8_t *dst, size_t size);
 int nvm_stop(void);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __NVM_H_ */
@@ -0,0 +1,469 @@
+#ifndef __RIOTEE_PIPELINE_HPP_
+#define __RIOTEE_PIPELINE_HPP_
+
+/* Sensing pipelines composed at compile time.
+ *
+ * A pipeline is a source followed by a chain of stages. The source produces values of its out_type and every stage
+ * takes values of its in_type and passes zero or more values of its out_type to the next stage. Types of neighbouring
+ * stages are checked at compile time. Every stage calls its successor through a template parameter, so a complete
+ * pipeline inlines into Pipeline::run() without virtual calls.
+ *
+ * Declare pipelines as global variables. Stage state then lives in retained memory and carries over resets, e.g. an
+ * aggregate that was half full before a power failure is completed afterwards. The runtime initializes retained memory
+ * from the image after the constructors of global objects ran, so a pipeline must be initialized statically. All
+ * stages have constexpr constructors, but this only takes effect if every argument is a constant expression, e.g. a
+ * constexpr configuration. Declare pipelines with RIOTEE_CONSTINIT, which rejects a pipeline that would need a
+ * constructor at runtime.
+ *
+ *   static const int16_t taps[8] = {...};
+ *   static constexpr riotee_adc_cfg_t adc_cfg = {...};
+ *   RIOTEE_CONSTINIT static riotee::Pipeline<riotee::AdcSource<64>, riotee::Fir<8, 4>, riotee::Mean<int16_t, 16>,
+ *                                            riotee::BleSink<int16_t>>
+ *       pipe{riotee::AdcSource<64>(adc_cfg), riotee::Fir<8, 4>(taps), {}, riotee::BleSink<int16_t>(ADV_CH_ALL)};
+ *
+ *   void user_task(void *pvParameter) {
+ *     for (;;) {
+ *       wait_until_charged();
+ *       pipe.run();
+ *     }
+ *   }
+ *
+ * run() returns 0 or the error code of the first driver call that failed.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "riotee_adc.h"
+#include "riotee_ble.h"
+#include "riotee_dsp.h"
+#include "riotee_gate.h"
+#include "riotee_nvm.h"
+#include "riotee_progress.h"
+#include "riotee_stella.h"
+#include "riotee_tscomp.h"
+
+/* Requires constant initialization of a global variable */
+#if defined(__cpp_constinit)
+#define RIOTEE_CONSTINIT constinit
+#elif defined(__clang__)
+#define RIOTEE_CONSTINIT [[clang::require_constant_initialization]]
+#else
+#define RIOTEE_CONSTINIT __constinit
+#endif
+
+namespace riotee {
+
+namespace detail {
+
+template <typename... Stages>
+struct chain_ok : std::true_type {};
+
+template <typename A, typename B, typename... Rest>
+struct chain_ok<A, B, Rest...>
+    : std::integral_constant<bool, std::is_same<typename A::out_type, typename B::in_type>::value &&
+                                       chain_ok<B, Rest...>::value> {};
+
+/* Sinks count the values they receive. Stage state is rolled back with a checkpoint, the progress counter is not, so
+ * values that were already sent before the rollback are recognized and dropped. */
+class SendOnce {
+ public:
+  constexpr SendOnce() : n_received_(0), sent_{} {}
+
+  template <typename F>
+  int operator()(F &&send) {
+    int rc;
+    /* Without a counter in NVM, values sent before a rollback would be sent again */
+    if ((rc = riotee_progress_attach(&sent_)) != PROGRESS_ERR_OK)
+      return rc;
+    uint32_t idx = n_received_++;
+    if (idx < riotee_progress_get(&sent_))
+      return 0;
+    if ((rc = send()) != 0)
+      return rc;
+    return riotee_progress_commit(&sent_, idx + 1);
+  }
+
+ private:
+  uint32_t n_received_;
+  riotee_progress_t sent_;
+};
+
+}  // namespace detail
+
+/* N samples per run with riotee_adc_sample(). n_samples in cfg is ignored. */
+template <unsigned int N>
+class AdcSource {
+ public:
+  static_assert(N > 0 && N <= RIOTEE_ADC_MAX_SAMPLES, "Invalid number of samples");
+  using out_type = int16_t;
+
+  constexpr explicit AdcSource(const riotee_adc_cfg_t &cfg) : cfg_(cfg), buf_{} {
+    cfg_.n_samples = N;
+  }
+
+  template <typename Next>
+  int pull(Next &&next) {
+    int rc;
+    if ((rc = riotee_adc_sample(buf_, &cfg_)) != ADC_ERR_OK)
+      return rc;
+    for (unsigned int i = 0; i < N; i++) {
+      if ((rc = next(buf_[i])) != 0)
+        return rc;
+    }
+    return 0;
+  }
+
+ private:
+  riotee_adc_cfg_t cfg_;
+  int16_t buf_[N];
+};
+
+/* Passes Fn(value) on */
+template <typename In, typename Out, Out (*Fn)(In)>
+class Map {
+ public:
+  using in_type = In;
+  using out_type = Out;
+
+  template <typename Next>
+  int push(In value, Next &&next) {
+    return next(Fn(value));
+  }
+};
+
+/* Passes only values for which Fn returns true */
+template <typename T, bool (*Fn)(T)>
+class Filter {
+ public:
+  using in_type = T;
+  using out_type = T;
+
+  template <typename Next>
+  int push(T value, Next &&next) {
+    if (!Fn(value))
+      return 0;
+    return next(value);
+  }
+};
+
+/* FIR filter from riotee_dsp.h. The coefficients must outlive the pipeline. */
+template <unsigned int NTaps, unsigned int Decimation = 1>
+class Fir {
+ public:
+  using in_type = int16_t;
+  using out_type = int16_t;
+
+  constexpr explicit Fir(const int16_t *coeffs) : coeffs_(coeffs), fir_{}, state_{}, initialized_(false) {}
+
+  template <typename Next>
+  int push(int16_t value, Next &&next) {
+    if (!initialized_) {
+      riotee_fir_init(&fir_, coeffs_, NTaps, state_, Decimation);
+      initialized_ = true;
+    }
+    int16_t out;
+    if (riotee_fir_process(&fir_, &out, &value, 1) == 0)
+      return 0;
+    return next(out);
+  }
+
+ private:
+  const int16_t *coeffs_;
+  riotee_fir_t fir_;
+  int16_t state_[2 * NTaps];
+  bool initialized_;
+};
+
+/* Cascade of biquads from riotee_dsp.h */
+template <unsigned int NStages>
+class Iir {
+ public:
+  using in_type = int16_t;
+  using out_type = int16_t;
+
+  constexpr explicit Iir(const riotee_biquad_coeffs_t *coeffs)
+      : coeffs_(coeffs), iir_{}, stages_{}, initialized_(false) {}
+
+  template <typename Next>
+  int push(int16_t value, Next &&next) {
+    if (!initialized_) {
+      riotee_iir_init(&iir_, stages_, coeffs_, NStages);
+      initialized_ = true;
+    }
+    riotee_iir_process(&iir_, &value, &value, 1);
+    return next(value);
+  }
+
+ private:
+  const riotee_biquad_coeffs_t *coeffs_;
+  riotee_iir_t iir_;
+  riotee_biquad_t stages_[NStages];
+  bool initialized_;
+};
+
+/* Passes on only values that need to be transmitted according to riotee_gate.h */
+template <typename T>
+class Gate {
+ public:
+  using in_type = T;
+  using out_type = T;
+
+  constexpr explicit Gate(const riotee_gate_cfg_t &cfg) : gate_{cfg, 0.0f, 0, 0.0f, 0, false, 0, 0} {}
+
+  template <typename Next>
+  int push(T value, Next &&next) {
+    if (riotee_gate_check(&gate_, static_cast<float>(value)) == RIOTEE_GATE_SUPPRESS)
+      return 0;
+    int rc = next(value);
+    /* Retry with the next value if the sink failed */
+    if (rc != 0)
+      riotee_gate_reset(&gate_);
+    return rc;
+  }
+
+  const riotee_gate_t &gate() const {
+    return gate_;
+  }
+
+ private:
+  riotee_gate_t gate_;
+};
+
+/* Passes on the mean of every N values */
+template <typename T, unsigned int N, typename Acc = int32_t>
+class Mean {
+ public:
+  static_assert(N > 0, "Invalid number of values");
+  using in_type = T;
+  using out_type = T;
+
+  constexpr Mean() : sum_(0), n_(0) {}
+
+  template <typename Next>
+  int push(T value, Next &&next) {
+    sum_ += value;
+    if (++n_ < N)
+      return 0;
+    T mean = static_cast<T>(sum_ / static_cast<Acc>(N));
+    sum_ = 0;
+    n_ = 0;
+    return next(mean);
+  }
+
+ private:
+  Acc sum_;
+  unsigned int n_;
+};
+
+template <typename T, unsigned int N>
+struct Block {
+  T values[N];
+};
+
+/* Collects N values into a block, e.g. to send several samples in one packet */
+template <typename T, unsigned int N>
+class Batch {
+ public:
+  static_assert(N > 0, "Invalid number of values");
+  using in_type = T;
+  using out_type = Block<T, N>;
+
+  constexpr Batch() : block_{}, n_(0) {}
+
+  template <typename Next>
+  int push(T value, Next &&next) {
+    block_.values[n_++] = value;
+    if (n_ < N)
+      return 0;
+    n_ = 0;
+    return next(block_);
+  }
+
+ private:
+  Block<T, N> block_;
+  unsigned int n_;
+};
+
+/* Packs values into blocks of Size bytes with riotee_tscomp.h, e.g. STELLA_MAX_PAYLOAD bytes for StellaSink or a
+ * record of NvmSink. A block is passed on when the next value does not fit anymore. */
+template <typename T, riotee_tscomp_codec_t Codec, unsigned int Size>
+class Compress {
+ public:
+  static_assert(Size >= RIOTEE_TSCOMP_HEADER_SIZE + sizeof(uint32_t), "Block too small for a single value");
+  using in_type = T;
+  using out_type = Block<uint8_t, Size>;
+
+  constexpr Compress() : enc_{}, block_{}, initialized_(false) {}
+
+  template <typename Next>
+  int push(T value, Next &&next) {
+    if (!initialized_)
+      start();
+    if (put(value) != TSCOMP_ERR_FULL)
+      return 0;
+
+    riotee_tscomp_finish(&enc_);
+    int rc = next(block_);
+    /* A block that the sink failed to take is dropped */
+    start();
+    put(value);
+    return rc;
+  }
+
+ private:
+  void start() {
+    memset(block_.values, 0, Size);
+    riotee_tscomp_init(&enc_, Codec, block_.values, Size);
+    initialized_ = true;
+  }
+
+  int put(T value) {
+    if constexpr (Codec == RIOTEE_TSCOMP_XOR)
+      return riotee_tscomp_put_float(&enc_, static_cast<float>(value));
+    else
+      return riotee_tscomp_put_int(&enc_, static_cast<int32_t>(value));
+  }
+
+  riotee_tscomp_t enc_;
+  Block<uint8_t, Size> block_;
+  bool initialized_;
+};
+
+/* Advertises every value as BLE payload. riotee_ble_prepare_adv() must have been called with a data_len of
+ * sizeof(T). A value is not sent twice when a checkpoint rolls the pipeline back. */
+template <typename T>
+class BleSink {
+ public:
+  using in_type = T;
+  using out_type = void;
+
+  constexpr explicit BleSink(riotee_adv_ch_t ch) : ch_(ch), once_() {}
+
+  template <typename Next>
+  int push(T value, Next &&) {
+    return once_([&]() { return riotee_ble_advertise(&value, ch_); });
+  }
+
+ private:
+  riotee_adv_ch_t ch_;
+  detail::SendOnce once_;
+};
+
+/* Sends every value to the basestation. Values that were not acknowledged are dropped and the error is returned. */
+template <typename T>
+class StellaSink {
+ public:
+  using in_type = T;
+  using out_type = void;
+
+  constexpr StellaSink() : once_() {}
+
+  template <typename Next>
+  int push(T value, Next &&) {
+    return once_([&]() { return riotee_stella_send(reinterpret_cast<uint8_t *>(&value), sizeof(T)); });
+  }
+
+ private:
+  detail::SendOnce once_;
+};
+
+/* Appends every value to a ring of Capacity records in NVM starting at Addr. The ring must not overlap with the
+ * checkpoint at address 0 or the progress log at RIOTEE_PROGRESS_NVM_ADDR. After a rollback, the records written
+ * since the checkpoint are overwritten in place. */
+template <typename T, uint32_t Addr, uint32_t Capacity>
+class NvmSink {
+ public:
+  static_assert(Capacity > 0, "Invalid capacity");
+  static_assert(Addr + Capacity * sizeof(T) <= RIOTEE_PROGRESS_NVM_ADDR, "Ring overlaps with the progress log");
+  using in_type = T;
+  using out_type = void;
+
+  constexpr NvmSink() : n_written_(0) {}
+
+  template <typename Next>
+  int push(T value, Next &&) {
+    int rc;
+    /* The sys task uses the NVM for checkpoints */
+    taskENTER_CRITICAL();
+    if ((rc = nvm_start(NVM_WRITE, addr(n_written_))) == 0) {
+      rc = nvm_write(reinterpret_cast<uint8_t *>(&value), sizeof(T));
+      nvm_stop();
+      if (rc == 0)
+        n_written_++;
+    }
+    taskEXIT_CRITICAL();
+    return rc;
+  }
+
+  /* Total number of values written. Only the last Capacity values are kept. */
+  uint32_t n_written() const {
+    return n_written_;
+  }
+
+  /* Reads the value with index idx, counted from the first value ever written */
+  int read(uint32_t idx, T *dst) const {
+    int rc;
+    if ((idx >= n_written_) || (n_written_ - idx > Capacity))
+      return -1;
+    taskENTER_CRITICAL();
+    if ((rc = nvm_start(NVM_READ, addr(idx))) == 0) {
+      rc = nvm_read(reinterpret_cast<uint8_t *>(dst), sizeof(T));
+      nvm_stop();
+    }
+    taskEXIT_CRITICAL();
+    return rc;
+  }
+
+ private:
+  static uint32_t addr(uint32_t idx) {
+    return Addr + (idx % Capacity) * sizeof(T);
+  }
+
+  uint32_t n_written_;
+};
+
+template <typename Source, typename... Stages>
+class Pipeline {
+ public:
+  static_assert(sizeof...(Stages) > 0, "Pipeline needs at least one stage");
+  static_assert(detail::chain_ok<Source, Stages...>::value, "Output type of every stage must match the next input type");
+
+  constexpr Pipeline(const Source &source, const Stages &...stages) : source_(source), stages_(stages...) {}
+
+  /* Pulls one batch of values from the source and pushes them through all stages */
+  int run() {
+    return source_.pull([this](const typename Source::out_type &value) { return push<0>(value); });
+  }
+
+  Source &source() {
+    return source_;
+  }
+
+  template <size_t I>
+  typename std::tuple_element<I, std::tuple<Stages...>>::type &stage() {
+    return std::get<I>(stages_);
+  }
+
+ private:
+  template <size_t I, typename T>
+  int push(const T &value) {
+    if constexpr (I + 1 == sizeof...(Stages))
+      return std::get<I>(stages_).push(value, [](const auto &) { return 0; });
+    else
+      return std::get<I>(stages_).push(value, [this](const auto &out) { return push<I + 1>(out); });
+  }
+
+  Source source_;
+  std::tuple<Stages...> stages_;
+};
+
+}  // namespace riotee
+
+#endif /* __RIOTEE_PIPELINE_HPP_ */
@@ -0,0 +1,81 @@
+#ifndef __RIOTEE_PROBE_H_
+#define __RIOTEE_PROBE_H_
+
+/* Cycle-accurate probes based on the DWT cycle counter of the Cortex-M4.
+ *
+ * Every probe accumulates number of calls and min/max/total cycles in a fixed table. Probes are only compiled in if
+ * RIOTEE_PROBES is set to 1, e.g. by building with 'make PROBES=1'. Otherwise the macros below expand to nothing.
+ *
+ * The cycle counter stops while the CPU sleeps. For blocking calls, the result is the number of cycles the CPU was
+ * active until the call returned, including interrupts and other tasks. The table is not retained and covers the time
+ * since the last reset.
+ */
+
+#include <stdint.h>
+
+#include "nrf.h"
+
+#ifndef RIOTEE_PROBES
+#define RIOTEE_PROBES 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  RIOTEE_PROBE_CHECKPOINT_STORE,
+  RIOTEE_PROBE_CHECKPOINT_LOAD,
+  RIOTEE_PROBE_TEARDOWN,
+  RIOTEE_PROBE_BLE_ADVERTISE,
+  RIOTEE_PROBE_STELLA_TRANSCEIVE,
+  RIOTEE_PROBE_ADC_SAMPLE,
+  /* Free for use by the application */
+  RIOTEE_PROBE_USER0,
+  RIOTEE_PROBE_USER1,
+  RIOTEE_PROBE_USER2,
+  RIOTEE_PROBE_USER3,
+  RIOTEE_PROBE_N
+} riotee_probe_id_t;
+
+typedef struct {
+  uint32_t n_calls;
+  uint32_t cycles_min;
+  uint32_t cycles_max;
+  uint64_t cycles_sum;
+} riotee_probe_stats_t;
+
+/* Enables the cycle counter and clears the table. Gets called by the runtime after every reset. */
+void riotee_probe_init(void);
+
+/* Adds one measurement to the table. Can be called from tasks and interrupts. */
+void riotee_probe_record(riotee_probe_id_t id, uint32_t cycles);
+
+/* Copies the statistics of one probe to dst. Returns -1 if the probe does not exist. */
+int riotee_probe_get(riotee_probe_stats_t *dst, riotee_probe_id_t id);
+
+/* Sets the name that is printed for one of the RIOTEE_PROBE_USER probes */
+int riotee_probe_set_name(riotee_probe_id_t id, const char *name);
+
+void riotee_probe_reset(void);
+
+/* Prints one line per probe that was called at least once: PROBE <name> n= min= avg= max= */
+void riotee_probe_dump(void);
+
+static inline uint32_t riotee_probe_cycles(void) {
+  return DWT->CYCCNT;
+}
+
+#if RIOTEE_PROBES
+#define RIOTEE_PROBE_START(id) const uint32_t __probe_start_##id = riotee_probe_cycles()
+#define RIOTEE_PROBE_STOP(id) riotee_probe_record(id, riotee_probe_cycles() - __probe_start_##id)
+#else
+#define RIOTEE_PROBE_START(id)
+#define RIOTEE_PROBE_STOP(id)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_PROBE_H_ */
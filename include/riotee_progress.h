@@ -0,0 +1,119 @@
+#ifndef __RIOTEE_PROGRESS_H_
+#define __RIOTEE_PROGRESS_H_
+
+/* Monotonic progress for loops and task graphs.
+ *
+ * After a power failure the application continues from the last checkpoint. If the device ran on after that
+ * checkpoint and then lost power before the next one completed, work done in between is repeated. A progress counter
+ * is a retained variable whose value is additionally committed to a small log in NVM outside of the checkpoint. When a
+ * checkpoint is restored, the runtime moves every attached counter forward to its last committed value, so a loop
+ * iteration or task that was committed is never started again.
+ *
+ * Every commit is one short NVM transaction. Commit after units of work that are expensive or harmful to repeat, e.g.
+ * a radio transmission. Work between two commits may run more than once and should be idempotent.
+ *
+ * A restore rolls retained memory back to the checkpoint, which may be several commits old, while the counter moves
+ * forward to the last commit. Results of committed work that live in retained memory would be lost. Bind such data to
+ * the counter with riotee_progress_bind(), so that it is written to NVM with every commit and restored together with
+ * the counter. The task graph does this for its context. Results that are kept elsewhere, e.g. in NVM or sent over the
+ * radio, need no binding.
+ *
+ * Counters must be global or static variables, so that they are retained. A zero-initialized counter is ready to use
+ * and attaches itself on first use.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of counters that can be attached at the same time */
+#define RIOTEE_PROGRESS_N_SLOTS 8
+/* Maximum size of the data bound to a counter */
+#define RIOTEE_PROGRESS_MAX_DATA 512
+
+/* Start of the commit log in NVM, followed by two copies of the bound data of every slot. Must not overlap with the
+ * checkpoint at address 0. */
+#ifndef RIOTEE_PROGRESS_NVM_ADDR
+#define RIOTEE_PROGRESS_NVM_ADDR 0xF0000
+#endif
+
+typedef struct {
+  uint32_t value;
+  /* Incremented with every commit */
+  uint32_t seq;
+  /* Slot in the NVM log plus one or 0 if not yet attached */
+  uint32_t slot;
+  /* Data that is committed together with the counter or NULL, see riotee_progress_bind() */
+  void *data;
+  uint32_t size;
+} riotee_progress_t;
+
+/* Runs one task of a task graph and returns the ID of the next task or RIOTEE_TASK_DONE */
+typedef uint32_t (*riotee_task_fn_t)(void *ctx);
+
+#define RIOTEE_TASK_DONE 0xFFFFFFFFUL
+/* Task IDs are stored in the lower half of the progress counter */
+#define RIOTEE_TASK_MAX_TASKS 0xFFFF
+
+enum { PROGRESS_ERR_OK = 0, PROGRESS_ERR_GENERIC = -1, PROGRESS_ERR_FULL = -2 };
+
+/* Assigns a slot in the NVM log and picks up a value committed by an earlier attachment of the same counter. Does
+ * nothing if the counter is already attached. */
+int riotee_progress_attach(riotee_progress_t *progress);
+
+/* Sets the counter to value and writes it to NVM. Takes effect atomically with respect to checkpoints. */
+int riotee_progress_commit(riotee_progress_t *progress, uint32_t value);
+
+/* Writes size bytes at data to NVM with every commit and restores them when the counter is restored. Call before the
+ * counter is first used. data must be retained. */
+int riotee_progress_bind(riotee_progress_t *progress, void *data, size_t size);
+
+/* Commits expected + 1 if the counter is still at expected. If a restore moved the counter elsewhere, changes to the
+ * bound data since the last commit are discarded instead. If the commit fails, e.g. because the NVM is not ready or
+ * all slots are taken, the counter still advances in RAM and the error is returned. */
+int riotee_progress_advance(riotee_progress_t *progress, uint32_t expected);
+
+static inline uint32_t riotee_progress_get(const riotee_progress_t *progress) {
+  return progress->value;
+}
+
+/* Loops i from 0 to n-1 and commits after every iteration. After a reset, the loop continues behind the last
+ * committed iteration. The counter keeps counting across runs of the loop, every run starts at the next multiple of n.
+ * An iteration only commits if the counter still points at it. If a checkpoint from inside an iteration is restored
+ * after that iteration had already committed, the rest of it runs once more without committing and the loop continues
+ * at the iteration that was interrupted. Leaving the loop with break skips the commit, so the next run continues at the
+ * same iteration. Outputs in retained memory must be bound to the counter. If a commit fails, the loop continues
+ * without protection against repeated iterations.
+ *
+ *   static riotee_progress_t tx_progress;
+ *   RIOTEE_PROGRESS_FOR(&tx_progress, i, N_PACKETS) {
+ *     riotee_ble_advertise(&packets[i], ADV_CH_ALL);
+ *   }
+ *
+ *   static int16_t temps[N_SAMPLES];
+ *   riotee_progress_bind(&temp_progress, temps, sizeof(temps));
+ *   RIOTEE_PROGRESS_FOR(&temp_progress, i, N_SAMPLES) {
+ *     temps[i] = read_temperature();
+ *   }
+ */
+#define RIOTEE_PROGRESS_FOR(progress, i, n)                                                          \
+  for (uint32_t i = (riotee_progress_attach(progress), riotee_progress_get(progress) % (n)),         \
+                __progress_end_##i = riotee_progress_get(progress) - i + (n);                        \
+       riotee_progress_get(progress) < __progress_end_##i;                                           \
+       riotee_progress_advance((progress), __progress_end_##i - (n) + i), i = riotee_progress_get(progress) % (n))
+
+/* Runs the tasks of a graph starting at task 0. Every task returns the ID of its successor, which is committed together
+ * with the ctx_size bytes at ctx before the successor runs. After a reset, the graph continues with the task that was
+ * running on the context of the last commit. Returns when a task returns RIOTEE_TASK_DONE. The next call starts a new
+ * run at task 0. ctx must be retained and at most RIOTEE_PROGRESS_MAX_DATA bytes. */
+int riotee_task_graph_run(riotee_progress_t *progress, const riotee_task_fn_t *tasks, uint32_t n_tasks, void *ctx,
+                          size_t ctx_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_PROGRESS_H_ */
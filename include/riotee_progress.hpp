@@ -0,0 +1,52 @@
+#ifndef __RIOTEE_PROGRESS_HPP_
+#define __RIOTEE_PROGRESS_HPP_
+
+/* C++ front end of riotee_progress.h. The task table is built at compile time from plain functions. */
+
+#include <stdint.h>
+
+#include "riotee_progress.h"
+
+namespace riotee {
+
+/* Calls body(i) for i from 0 to n-1 and commits after every call. See RIOTEE_PROGRESS_FOR. */
+template <typename F>
+inline void progress_for(riotee_progress_t &progress, uint32_t n, F &&body) {
+  RIOTEE_PROGRESS_FOR(&progress, i, n) {
+    body(i);
+  }
+}
+
+/* Task graph over a context of type Ctx. Task IDs are the positions in the template argument list. The context is
+ * committed with every transition, so send() sees what sample() stored even if a restore happened in between.
+ *
+ *   uint32_t sample(State &s);
+ *   uint32_t send(State &s);
+ *   using Graph = riotee::TaskGraph<State, sample, send>;
+ *   Graph::run(progress, state);
+ */
+template <typename Ctx, uint32_t (*... Tasks)(Ctx &)>
+class TaskGraph {
+ public:
+  static_assert(sizeof...(Tasks) > 0, "Task graph needs at least one task");
+  static_assert(sizeof...(Tasks) <= RIOTEE_TASK_MAX_TASKS, "Too many tasks");
+  static_assert(sizeof(Ctx) <= RIOTEE_PROGRESS_MAX_DATA, "Context too large to be committed");
+
+  static constexpr uint32_t n_tasks = sizeof...(Tasks);
+
+  static int run(riotee_progress_t &progress, Ctx &ctx) {
+    return riotee_task_graph_run(&progress, table, n_tasks, &ctx, sizeof(Ctx));
+  }
+
+ private:
+  template <uint32_t (*Task)(Ctx &)>
+  static uint32_t thunk(void *ctx) {
+    return Task(*static_cast<Ctx *>(ctx));
+  }
+
+  static constexpr riotee_task_fn_t table[] = {thunk<Tasks>...};
+};
+
+}  // namespace riotee
+
+#endif /* __RIOTEE_PROGRESS_HPP_ */
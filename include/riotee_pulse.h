@@ -0,0 +1,46 @@
+#ifndef __RIOTEE_PULSE_H_
+#define __RIOTEE_PULSE_H_
+
+/* Hardware pulse counter.
+ *
+ * Edges on a pin are routed from a GPIOTE IN event through PPI to TIMER3 in counter mode, so pulses are counted
+ * without waking the CPU. The count is part of every checkpoint and counting resumes after a reset. Pulses that occur
+ * between the last checkpoint and the reset are lost.
+ *
+ * Uses GPIOTE channel 0, PPI channel 8 and TIMER3.
+ */
+
+#include <stdint.h>
+
+#include "nrf.h"
+#include "riotee_gpint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  RIOTEE_PULSE_EDGE_RISING = GPIOTE_CONFIG_POLARITY_LoToHi,
+  RIOTEE_PULSE_EDGE_FALLING = GPIOTE_CONFIG_POLARITY_HiToLo,
+  RIOTEE_PULSE_EDGE_BOTH = GPIOTE_CONFIG_POLARITY_Toggle,
+} riotee_pulse_edge_t;
+
+enum { PULSE_ERR_OK = 0, PULSE_ERR_GENERIC = -1, PULSE_ERR_BUSY = -2, PULSE_ERR_UNSUPPORTED = -3 };
+
+/* Starts counting edges on pin. pin is the absolute pin number, i.e. pins on P1 start at 32. The count starts at 0. */
+int riotee_pulse_start(uint32_t pin, riotee_pulse_edge_t edge, riotee_gpio_pin_pull_t pull);
+
+/* Stops counting. The count is kept until the counter is started again. */
+int riotee_pulse_stop(void);
+
+/* Returns the number of edges since riotee_pulse_start() */
+uint64_t riotee_pulse_count(void);
+
+/* Sets the count to 0 without stopping the counter */
+void riotee_pulse_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_PULSE_H_ */
@@ -1,24 +1,14 @@
 #ifndef __STELLA_H_
 #define __STELLA_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
-typedef struct __attribute__((packed)) {
-  /* ID of the sender of this packet */
-  uint32_t dev_id;
-  /* ID of the packet */
-  uint16_t pkt_id;
-  /* ID of a previous packet that is acknowledged with this packet */
-  uint16_t ack_id;
-} riotee_stella_pkt_header_t;
-
-typedef struct __attribute__((packed)) {
-  /* Lenght of the packet, excluding this one byte length field */
-  uint8_t len;
-  riotee_stella_pkt_header_t hdr;
-  /* Max payload size is 255. We have 8 Byte protocol overhead. */
-  uint8_t data[255 - sizeof(riotee_stella_pkt_header_t)];
-} riotee_stella_pkt_t;
+#include "riotee_stella_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 int riotee_stella_init(void);
 
@@ -31,6 +21,8 @@ int riotee_stella_send(uint8_t *data, size_t n);
 /* Set the ID that our device uses to identify to the nework */
 void riotee_stella_set_id(uint32_t dev_id);
 
-enum { STELLA_ERR_OK = 0, STELLA_ERR_GENERIC = -1, STELLA_ERR_RESET = -2, STELLA_ERR_NOACK = 1 };
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* __STELLA_H_ */
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef __STELLA_CODEC_H_
+#define __STELLA_CODEC_H_
+
+/* Stella packet format and protocol rules. This header and stella_codec.c do not depend on any hardware and are also
+ * compiled for the host tools. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Timeout for receiving the address of an acknowledgement after the radio is ready for reception */
+#define STELLA_ACK_TIMEOUT_US 100
+
+typedef struct __attribute__((packed)) {
+  /* ID of the sender of this packet */
+  uint32_t dev_id;
+  /* ID of the packet */
+  uint16_t pkt_id;
+  /* ID of a previous packet that is acknowledged with this packet */
+  uint16_t ack_id;
+} riotee_stella_pkt_header_t;
+
+typedef struct __attribute__((packed)) {
+  /* Lenght of the packet, excluding this one byte length field */
+  uint8_t len;
+  riotee_stella_pkt_header_t hdr;
+  /* Max payload size is 255. We have 8 Byte protocol overhead. */
+  uint8_t data[255 - sizeof(riotee_stella_pkt_header_t)];
+} riotee_stella_pkt_t;
+
+enum { STELLA_ERR_OK = 0, STELLA_ERR_GENERIC = -1, STELLA_ERR_RESET = -2, STELLA_ERR_NOACK = 1 };
+
+/* Maximum number of payload bytes per packet */
+#define STELLA_MAX_PAYLOAD (sizeof(((riotee_stella_pkt_t *)0)->data))
+/* Maximum size of an encoded packet including the length field */
+#define STELLA_MAX_FRAME (1 + 255)
+
+/* Fills in header and payload of pkt. Returns STELLA_ERR_GENERIC if the payload does not fit. */
+int riotee_stella_pkt_build(riotee_stella_pkt_t *pkt, uint32_t dev_id, uint16_t pkt_id, uint16_t ack_id,
+                            const uint8_t *data, size_t n);
+
+/* Returns the number of payload bytes in pkt or STELLA_ERR_GENERIC if the length field is invalid. */
+int riotee_stella_pkt_payload_len(const riotee_stella_pkt_t *pkt);
+
+/* Serializes pkt into its on-air representation (little endian, without CRC). Returns number of bytes written. */
+int riotee_stella_encode(uint8_t *dst, size_t size, const riotee_stella_pkt_t *pkt);
+
+/* Parses n bytes of an on-air representation into pkt. Returns STELLA_ERR_GENERIC on malformed input. */
+int riotee_stella_decode(riotee_stella_pkt_t *pkt, const uint8_t *src, size_t n);
+
+/* Builds the acknowledgement a basestation sends in response to the uplink packet ul */
+int riotee_stella_build_ack(riotee_stella_pkt_t *ack, const riotee_stella_pkt_t *ul, uint16_t pkt_id,
+                            const uint8_t *data, size_t n);
+
+/* Checks if ack is a valid acknowledgement for the uplink packet ul. */
+int riotee_stella_check_ack(const riotee_stella_pkt_t *ack, const riotee_stella_pkt_t *ul);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STELLA_CODEC_H_ */
@@ -0,0 +1,72 @@
+#ifndef __RIOTEE_TIMER_H_
+#define __RIOTEE_TIMER_H_
+
+/* Software timers on top of a single RTC0 compare channel.
+ *
+ * Any number of one-shot and periodic timers can be active at the same time. Active timers are kept in a list sorted by
+ * deadline and the compare channel is always set to the earliest deadline. When a timer expires, its callback is
+ * called from the RTC0 interrupt or, if no callback is set, the task is notified on notification index 1.
+ *
+ * All times are in ticks of the 32768Hz low frequency clock. Timers are not retained: after a reset, all timers are
+ * stopped.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct riotee_timer riotee_timer_t;
+
+/* Gets called from interrupt context when the timer expires */
+typedef void (*riotee_timer_cb_t)(riotee_timer_t *timer);
+
+struct riotee_timer {
+  riotee_timer_t *next;
+  uint64_t deadline;
+  /* Interval for periodic timers or 0 for one-shot timers */
+  uint32_t period;
+  riotee_timer_cb_t cb;
+  /* Task that is notified if cb is NULL */
+  TaskHandle_t task;
+  uint32_t notify_value;
+  /* Free for use by the callback */
+  void *ctx;
+};
+
+enum { TIMER_ERR_OK = 0, TIMER_ERR_GENERIC = -1 };
+
+int riotee_timer_init(void);
+
+/* Sets up a timer that calls cb on expiry */
+void riotee_timer_init_cb(riotee_timer_t *timer, riotee_timer_cb_t cb, void *ctx);
+
+/* Sets up a timer that notifies task with notify_value on expiry */
+void riotee_timer_init_notify(riotee_timer_t *timer, TaskHandle_t task, uint32_t notify_value);
+
+/* (Re-)starts the timer to expire after ticks and, if period is not 0, every period ticks afterwards. Can be called
+ * from tasks and interrupts. */
+int riotee_timer_start(riotee_timer_t *timer, uint32_t ticks, uint32_t period);
+
+/* (Re-)starts the timer to expire at an absolute time as returned by riotee_timer_now(). Deadlines in the past expire
+ * right away. */
+int riotee_timer_start_at(riotee_timer_t *timer, uint64_t deadline, uint32_t period);
+
+/* Stops the timer. Can be called from tasks and interrupts and on timers that are not running. */
+int riotee_timer_stop(riotee_timer_t *timer);
+
+bool riotee_timer_is_active(riotee_timer_t *timer);
+
+/* Returns the number of ticks since the RTC was started */
+uint64_t riotee_timer_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_TIMER_H_ */
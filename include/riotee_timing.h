@@ -1,5 +1,6 @@
 #ifndef __TIMING_H_
 #define __TIMING_H_
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -8,10 +9,33 @@ extern "C" {
 
 int riotee_timing_init(void);
 
-/* Sleep for number of 32768kHz ticks */
-void riotee_sleep_ticks(unsigned int ticks_32k);
-void riotee_sleep_ms(unsigned int ms);
+/* Sleep for number of 32768Hz ticks. Returns 0 if the full time has passed and -1 if sleep was interrupted. */
+int riotee_sleep_ticks(unsigned int ticks_32k);
+int riotee_sleep_ms(unsigned int ms);
 
+/* Returns 32768Hz ticks since the first boot after programming. The value is checkpointed and keeps counting across
+ * resets. Time the device was off is only included if the AM1805 is enabled with riotee_time_use_am1805(). */
+uint64_t riotee_time_now(void);
+
+/* Corrects riotee_time_now() for the time the device was off using the AM1805 RTC. Call am1805_init() first. The
+ * setting is retained. */
+void riotee_time_use_am1805(bool enable);
+
+/* Converts milliseconds to ticks of riotee_time_now() */
+#define RIOTEE_TIME_MS(ms) ((uint64_t)(ms)*32768 / 1000)
+
+/* Sleeps until riotee_time_now() reaches deadline. Unlike riotee_sleep_ticks(), the sleep continues after a reset
+ * until the deadline is reached, taking into account the time the device was off if the AM1805 is enabled. Returns 0
+ * when the deadline is reached or has already passed and -1 if sleep was interrupted by another event. */
+int riotee_sleep_until(uint64_t deadline);
+
+/* Sleeps until *next and advances *next by period. Periods that were missed are skipped, so wakeups stay on the grid
+ * of *next + k * period. Keep *next in a global variable, so it is retained, and initialize it with
+ * riotee_time_now(). */
+int riotee_sleep_periodic(uint64_t *next, uint32_t period);
+
+/* Busy delays that do not need the scheduler and can be used inside critical sections. Longer delays sleep until a
+ * hardware timer (TIMER1) expires. Time the device was off or the user task was suspended does not count. */
 void riotee_delay_us(unsigned int us);
 void riotee_delay_ms(unsigned int ms);
 
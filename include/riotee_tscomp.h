@@ -0,0 +1,75 @@
+#ifndef __RIOTEE_TSCOMP_H_
+#define __RIOTEE_TSCOMP_H_
+
+/* Compression of sensor time series into bit-packed blocks, e.g. for NVM records or Stella payloads.
+ *
+ * A block starts with a 3 byte header (codec and little-endian value count) followed by the bit-packed values, most
+ * significant bit first. The first value is stored verbatim, every further value relative to its predecessors:
+ *
+ *  - DELTA: integer difference to the previous value
+ *  - DOD: difference of consecutive differences, small for values that change at a steady rate, e.g. timestamps
+ *  - XOR: float bits XOR the previous float bits, short for floats that change little (Gorilla)
+ *
+ * DELTA and DOD differences are zigzag coded and stored as '0' for 0, '10' + 7 bits, '110' + 9 bits, '1110' + 12 bits
+ * or '1111' + 32 bits. XOR stores '0' for an unchanged value, '10' + the meaningful bits if they fit into the window of
+ * the previous value, or '11' + 5 bits leading zeros + 5 bits length - 1 + the meaningful bits.
+ *
+ * This header and tscomp.c do not depend on any hardware and are also compiled for the host tools.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { RIOTEE_TSCOMP_DELTA = 1, RIOTEE_TSCOMP_DOD = 2, RIOTEE_TSCOMP_XOR = 3 } riotee_tscomp_codec_t;
+
+enum { TSCOMP_ERR_OK = 0, TSCOMP_ERR_GENERIC = -1, TSCOMP_ERR_FULL = -2 };
+
+#define RIOTEE_TSCOMP_HEADER_SIZE 3
+/* Limited by the 16 bit count in the header */
+#define RIOTEE_TSCOMP_MAX_VALUES 0xFFFF
+
+typedef struct {
+  uint8_t *buf;
+  size_t size;
+  /* Number of bits used including the header */
+  size_t n_bits;
+  unsigned int count;
+  riotee_tscomp_codec_t codec;
+  /* Previous value, for XOR its bit pattern */
+  uint32_t prev;
+  uint32_t prev_delta;
+  /* Window of meaningful bits of the previous XOR */
+  uint8_t leading;
+  uint8_t length;
+} riotee_tscomp_t;
+
+/* Starts a new block in buf. size must be at least RIOTEE_TSCOMP_HEADER_SIZE. */
+int riotee_tscomp_init(riotee_tscomp_t *enc, riotee_tscomp_codec_t codec, uint8_t *buf, size_t size);
+
+/* Appends a value to a DELTA or DOD block. Returns TSCOMP_ERR_FULL and leaves the block unchanged if the value does
+ * not fit. */
+int riotee_tscomp_put_int(riotee_tscomp_t *enc, int32_t value);
+
+/* Appends a value to an XOR block. Returns TSCOMP_ERR_FULL and leaves the block unchanged if the value does not fit. */
+int riotee_tscomp_put_float(riotee_tscomp_t *enc, float value);
+
+/* Writes the header and returns the number of bytes of the block. More values can be appended afterwards. */
+size_t riotee_tscomp_finish(riotee_tscomp_t *enc);
+
+/* Returns the codec of the block in buf or TSCOMP_ERR_GENERIC */
+int riotee_tscomp_codec(const uint8_t *buf, size_t size);
+
+/* Decode the block in buf into at most n_max values. Return the number of values or TSCOMP_ERR_GENERIC if the block is
+ * invalid, truncated or holds more than n_max values. If n_bytes is not NULL, it receives the size of the block. */
+int riotee_tscomp_decode_int(int32_t *dst, size_t n_max, const uint8_t *buf, size_t size, size_t *n_bytes);
+int riotee_tscomp_decode_float(float *dst, size_t n_max, const uint8_t *buf, size_t size, size_t *n_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RIOTEE_TSCOMP_H_ */
@@ -36,12 +36,48 @@ enum {
 typedef struct {
   unsigned int n_reset;
   unsigned int n_turnoff;
+  /* Number of checkpoints written to NVM */
+  unsigned int n_checkpoint;
+  /* Total number of bytes written to NVM by checkpoints */
+  unsigned int checkpoint_bytes;
 } runtime_stats_t;
 
+/* Peripheral states with significant current consumption that are tracked by the drivers */
+typedef enum {
+  ACCT_RADIO_TX,
+  ACCT_RADIO_RX,
+  ACCT_HFXO_BLE,
+  ACCT_HFXO_STELLA,
+  ACCT_SAADC,
+  ACCT_TWIM,
+  ACCT_SPIM_SPIC,
+  ACCT_SPIM_NVM,
+  ACCT_N
+} acct_domain_t;
+
+typedef struct {
+  /* Accumulated active time per domain in microseconds */
+  uint64_t active_us[ACCT_N];
+  /* Number of times each domain was activated */
+  unsigned int n_active[ACCT_N];
+} runtime_acct_t;
+
 extern TaskHandle_t usr_task_handle;
 extern TaskHandle_t sys_task_handle;
 
 extern runtime_stats_t runtime_stats;
+extern runtime_acct_t runtime_acct;
+
+/* Marks the start/end of an active period of a domain. Can be called from tasks and interrupts. */
+void acct_start(acct_domain_t domain);
+void acct_stop(acct_domain_t domain);
+/* Adds an active period with known duration, e.g. the airtime of a packet */
+void acct_add_us(acct_domain_t domain, unsigned int us);
+
+/* Sets the current that a domain draws while active. The model is not retained, call this from reset_callback(). */
+int runtime_acct_set_current(acct_domain_t domain, unsigned int current_ua);
+/* Returns the estimated charge in nC consumed by a domain based on active time and current model */
+uint64_t runtime_acct_charge_nc(acct_domain_t domain);
 
 #define TEARDOWN_FUN(x) void (*x)() __attribute__((section(".teardown")))
 
@@ -1,131 +1,573 @@
+#include <stdbool.h>
+#include <string.h>
+
 #include "nrf.h"
 #include "riotee_adc.h"
 #include "riotee.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "runtime.h"
+#include "riotee_probe.h"
+#include "riotee_timing.h"
 
 #include "nrf_gpio.h"
 
 TEARDOWN_FUN(adc_teardown_ptr);
 
-/* Number of samples that still need to be taken before buffer is filled. */
-static unsigned int samples_remaining;
-static unsigned int sample_interval_ticks32;
+/* PPI channel that triggers a sample on every tick of the sample clock and restarts the clock */
+#define PPI_CH_CLOCK 6
+/* PPI channel that restarts the SAADC on a full buffer in streaming mode */
+#define PPI_CH_RESTART 7
+
+typedef enum { ADC_MODE_IDLE = 0, ADC_MODE_SAMPLE, ADC_MODE_STREAM, ADC_MODE_MONITOR } adc_mode_t;
+
+static volatile adc_mode_t mode;
+
+/* Buffers that EasyDMA alternates between in streaming mode */
+static int16_t *stream_buf[2];
+/* Number of blocks that were completely filled by EasyDMA */
+static volatile unsigned int n_blocks_done;
+/* Number of blocks that were handed to the user */
+static unsigned int n_blocks_read;
+
+/* Progress of a resumable acquisition, lives in retained user memory */
+static riotee_adc_progress_t *active_progress;
+
+/* EasyDMA overwrites this with every sample in monitoring mode */
+static int16_t monitor_sample;
+/* Limit that was crossed or RIOTEE_ADC_LIMIT_NONE while monitoring is still running */
+static volatile riotee_adc_limit_t monitor_limit;
 
 /* Inverse gain lookup table, indexed by riotee_adc_gain_t */
 static const float gain_lut[] = {6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 1.0f / 2, 1.0f / 4};
 /* Reference lookup table, indexed by enum riotee_adc_reference_t */
 static const float ref_lut[] = {0.6f, 0.5f};
 
-float riotee_adc_adc2vadc(int16_t adc, riotee_adc_cfg_t *cfg) {
+static float adc2vadc(int16_t adc, riotee_adc_gain_t gain, riotee_adc_reference_t reference, bool differential) {
   float res_fac;
   /* See nRF52833 Product Specification v1.5 sec 6.21.3*/
-  if (cfg->input_neg != RIOTEE_ADC_INPUT_NC) {
+  if (differential) {
     res_fac = 1.0f / (1 << 11);
   } else {
     res_fac = 1.0f / (1 << 12);
   }
-  return ref_lut[cfg->reference] * ((float)adc) * gain_lut[cfg->gain] * res_fac;
+  return ref_lut[reference] * ((float)adc) * gain_lut[gain] * res_fac;
+}
+
+float riotee_adc_adc2vadc(int16_t adc, riotee_adc_cfg_t *cfg) {
+  return adc2vadc(adc, cfg->gain, cfg->reference, cfg->input_neg != RIOTEE_ADC_INPUT_NC);
+}
+
+float riotee_adc_ch_adc2vadc(int16_t adc, riotee_adc_ch_cfg_t *cfg) {
+  return adc2vadc(adc, cfg->gain, cfg->reference, cfg->input_neg != RIOTEE_ADC_INPUT_NC);
+}
+
+static void scale_init(riotee_adc_scale_t *scale, riotee_adc_gain_t gain, riotee_adc_reference_t reference,
+                       bool differential) {
+  scale->volts_per_lsb = adc2vadc(1, gain, reference, differential);
+  /* At most 1.76mV per LSB, fits into Q14 */
+  scale->mv_per_lsb_q14 = (int16_t)(scale->volts_per_lsb * 1000.0f * (1 << 14) + 0.5f);
+}
+
+void riotee_adc_scale_init(riotee_adc_scale_t *scale, riotee_adc_cfg_t *cfg) {
+  scale_init(scale, cfg->gain, cfg->reference, cfg->input_neg != RIOTEE_ADC_INPUT_NC);
+}
+
+void riotee_adc_ch_scale_init(riotee_adc_scale_t *scale, riotee_adc_ch_cfg_t *cfg) {
+  scale_init(scale, cfg->gain, cfg->reference, cfg->input_neg != RIOTEE_ADC_INPUT_NC);
+}
+
+void riotee_adc_to_mv(int16_t *dst, const int16_t *src, unsigned int n, const riotee_adc_scale_t *scale) {
+  unsigned int i = 0;
+#if defined(__ARM_FEATURE_DSP)
+  /* Scale in the bottom halfword, zero in the top halfword: SMLAD multiplies the bottom sample, SMLADX the top one */
+  uint32_t factor = (uint16_t)scale->mv_per_lsb_q14;
+  uint32_t pair;
+
+  for (; i + 2 <= n; i += 2) {
+    /* Unaligned word access is fine on the Cortex-M4 */
+    memcpy(&pair, &src[i], sizeof(pair));
+    int32_t lo = (int32_t)__SMLAD(pair, factor, 1 << 13) >> 14;
+    int32_t hi = (int32_t)__SMLADX(pair, factor, 1 << 13) >> 14;
+    pair = __PKHBT(lo, hi, 16);
+    memcpy(&dst[i], &pair, sizeof(pair));
+  }
+#endif
+  for (; i < n; i++)
+    dst[i] = (int16_t)(((int32_t)src[i] * scale->mv_per_lsb_q14 + (1 << 13)) >> 14);
+}
+
+void riotee_adc_to_volts(float *dst, const int16_t *src, unsigned int n, const riotee_adc_scale_t *scale) {
+  const float f = scale->volts_per_lsb;
+  unsigned int i = 0;
+
+  /* Unrolled, so that loads, conversions and multiplications of independent samples can overlap */
+  for (; i + 4 <= n; i += 4) {
+    float v0 = (float)src[i] * f;
+    float v1 = (float)src[i + 1] * f;
+    float v2 = (float)src[i + 2] * f;
+    float v3 = (float)src[i + 3] * f;
+    dst[i] = v0;
+    dst[i + 1] = v1;
+    dst[i + 2] = v2;
+    dst[i + 3] = v3;
+  }
+  for (; i < n; i++)
+    dst[i] = (float)src[i] * f;
+}
+
+/* RTC2 generates the sample clock. The compare event triggers a sample and clears the counter via PPI. */
+static void sample_clock_start(unsigned int interval_ticks32) {
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->TASKS_CLEAR = 1;
+  NRF_RTC2->PRESCALER = 0;
+  /* Counter is cleared one tick after the compare event */
+  NRF_RTC2->CC[0] = interval_ticks32 - 1;
+  NRF_RTC2->EVENTS_COMPARE[0] = 0;
+  NRF_RTC2->EVTENSET = RTC_EVTEN_COMPARE0_Msk;
+  NRF_PPI->CHENSET = (1UL << PPI_CH_CLOCK);
+  NRF_RTC2->TASKS_START = 1;
+}
+
+static void sample_clock_stop(void) {
+  NRF_PPI->CHENCLR = (1UL << PPI_CH_CLOCK);
+  NRF_RTC2->EVTENCLR = RTC_EVTEN_COMPARE0_Msk;
+  NRF_RTC2->TASKS_STOP = 1;
+}
+
+static void configure_channel(unsigned int ch, riotee_adc_ch_cfg_t *cfg) {
+  NRF_SAADC->CH[ch].CONFIG = (SAADC_CH_CONFIG_RESP_Bypass << SAADC_CH_CONFIG_RESP_Pos) |
+                             (SAADC_CH_CONFIG_RESN_Bypass << SAADC_CH_CONFIG_RESN_Pos) |
+                             ((cfg->gain << SAADC_CH_CONFIG_GAIN_Pos) & SAADC_CH_CONFIG_GAIN_Msk) |
+                             ((cfg->reference << SAADC_CH_CONFIG_REFSEL_Pos) & SAADC_CH_CONFIG_REFSEL_Msk) |
+                             ((cfg->acq_time << SAADC_CH_CONFIG_TACQ_Pos) & SAADC_CH_CONFIG_TACQ_Msk);
+
+  NRF_SAADC->CH[ch].PSELP = cfg->input_pos;
+  NRF_SAADC->CH[ch].PSELN = cfg->input_neg;
+  if (cfg->input_neg != RIOTEE_ADC_INPUT_NC)
+    NRF_SAADC->CH[ch].CONFIG |= (SAADC_CH_CONFIG_MODE_Diff << SAADC_CH_CONFIG_MODE_Pos);
+}
+
+/* Channels with a connected input are sampled in order on every SAMPLE task, so the unused ones are disconnected */
+static void disable_channels_from(unsigned int ch) {
+  for (; ch < RIOTEE_ADC_MAX_CHANNELS; ch++)
+    NRF_SAADC->CH[ch].PSELP = RIOTEE_ADC_INPUT_NC;
+}
+
+static void configure_single(riotee_adc_cfg_t *cfg) {
+  riotee_adc_ch_cfg_t ch_cfg = {.gain = cfg->gain,
+                                .reference = cfg->reference,
+                                .acq_time = cfg->acq_time,
+                                .input_pos = cfg->input_pos,
+                                .input_neg = cfg->input_neg};
+  configure_channel(0, &ch_cfg);
+  disable_channels_from(1);
+
+  /* If oversampling is enabled, take samples as fast as possible in burst mode */
+  NRF_SAADC->OVERSAMPLE = cfg->oversampling;
+  if (cfg->oversampling != RIOTEE_ADC_OVERSAMPLE_DISABLED)
+    NRF_SAADC->CH[0].CONFIG |= (SAADC_CH_CONFIG_BURST_Enabled << SAADC_CH_CONFIG_BURST_Pos);
 }
 
 static inline void stop_sampling(void) {
-  NRF_SAADC->INTENCLR = SAADC_INTENCLR_END_Msk;
+  NRF_SAADC->INTENCLR = SAADC_INTENCLR_END_Msk | SAADC_INTENCLR_STARTED_Msk | SAADC_INTENCLR_CH0LIMITH_Msk |
+                        SAADC_INTENCLR_CH0LIMITL_Msk;
 
-  NRF_RTC0->EVTENCLR = RTC_EVTEN_COMPARE2_Msk;
+  sample_clock_stop();
+  NRF_PPI->CHENCLR = (1UL << PPI_CH_RESTART);
   NRF_SAADC->TASKS_STOP = 1;
   NRF_SAADC->EVENTS_END = 0;
+  NRF_SAADC->EVENTS_STARTED = 0;
+  NRF_SAADC->EVENTS_CH[0].LIMITH = 0;
+  NRF_SAADC->EVENTS_CH[0].LIMITL = 0;
+  /* Reset value, limits can never be crossed */
+  NRF_SAADC->CH[0].LIMIT = (0x7FFFUL << SAADC_CH_LIMIT_HIGH_Pos) | (0x8000UL << SAADC_CH_LIMIT_LOW_Pos);
 
   NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Disabled << SAADC_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SAADC);
+  mode = ADC_MODE_IDLE;
+  active_progress = NULL;
   adc_teardown_ptr = NULL;
 }
 
 void SAADC_IRQHandler(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-  NRF_SAADC->EVENTS_END = 0;
+  if (mode == ADC_MODE_MONITOR) {
+    if ((NRF_SAADC->EVENTS_CH[0].LIMITH == 1) || (NRF_SAADC->EVENTS_CH[0].LIMITL == 1)) {
+      monitor_limit = (NRF_SAADC->EVENTS_CH[0].LIMITH == 1) ? RIOTEE_ADC_LIMIT_HIGH : RIOTEE_ADC_LIMIT_LOW;
+      stop_sampling();
+      xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_ADC, eSetBits, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return;
+  }
+
+  /* A full buffer must be handled before the start of the next one */
+  if (NRF_SAADC->EVENTS_END == 1) {
+    NRF_SAADC->EVENTS_END = 0;
 
-  if (--samples_remaining == 0) {
-    stop_sampling();
+    if (mode == ADC_MODE_SAMPLE) {
+      if (active_progress != NULL)
+        active_progress->n_done += NRF_SAADC->RESULT.AMOUNT;
+      stop_sampling();
+    } else if (mode == ADC_MODE_STREAM) {
+      n_blocks_done++;
+    }
     xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_ADC, eSetBits, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-  } else {
-    NRF_SAADC->RESULT.PTR += 2;
-    NRF_RTC0->CC[2] = (NRF_RTC0->COUNTER + sample_interval_ticks32) % (1 << 24);
   }
+
+  if (NRF_SAADC->EVENTS_STARTED == 1) {
+    NRF_SAADC->EVENTS_STARTED = 0;
+    /* The buffer pointer is double-buffered. Prepare the buffer for the block after the one that just started. */
+    if (mode == ADC_MODE_STREAM)
+      NRF_SAADC->RESULT.PTR = (uint32_t)stream_buf[(n_blocks_done + 1) % 2];
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 static void teardown(void) {
+  taskENTER_CRITICAL();
+  if ((mode == ADC_MODE_SAMPLE) && (active_progress != NULL)) {
+    /* Record the samples that made it into the buffer, so the acquisition can be resumed */
+    sample_clock_stop();
+    NRF_PPI->CHENCLR = PPI_CHENCLR_CH5_Msk;
+    NRF_SAADC->EVENTS_STOPPED = 0;
+    NRF_SAADC->TASKS_STOP = 1;
+    while (NRF_SAADC->EVENTS_STOPPED == 0) {
+    }
+    active_progress->n_done += NRF_SAADC->RESULT.AMOUNT;
+  }
   stop_sampling();
+  taskEXIT_CRITICAL();
   xTaskNotifyIndexed(usr_task_handle, 1, EVT_TEARDOWN, eSetValueWithOverwrite);
 }
 
 int riotee_adc_init(void) {
   NRF_SAADC->RESOLUTION = SAADC_RESOLUTION_VAL_12bit;
 
-  NRF_PPI->CH[3].EEP = (uint32_t)&NRF_RTC0->EVENTS_COMPARE[2];
-  NRF_PPI->CH[3].TEP = (uint32_t)&NRF_SAADC->TASKS_START;
-  NRF_PPI->CHENSET = PPI_CHENSET_CH3_Msk;
-
+  /* Takes the first sample right after the start */
   NRF_PPI->CH[4].EEP = (uint32_t)&NRF_SAADC->EVENTS_STARTED;
   NRF_PPI->CH[4].TEP = (uint32_t)&NRF_SAADC->TASKS_SAMPLE;
-  NRF_PPI->CHENSET = PPI_CHENSET_CH4_Msk;
 
   NRF_PPI->CH[5].EEP = (uint32_t)&NRF_SAADC->EVENTS_END;
   NRF_PPI->CH[5].TEP = (uint32_t)&NRF_SAADC->TASKS_STOP;
-  NRF_PPI->CHENSET = PPI_CHENSET_CH5_Msk;
 
+  NRF_PPI->CH[PPI_CH_CLOCK].EEP = (uint32_t)&NRF_RTC2->EVENTS_COMPARE[0];
+  NRF_PPI->CH[PPI_CH_CLOCK].TEP = (uint32_t)&NRF_SAADC->TASKS_SAMPLE;
+  NRF_PPI->FORK[PPI_CH_CLOCK].TEP = (uint32_t)&NRF_RTC2->TASKS_CLEAR;
+
+  NRF_PPI->CH[PPI_CH_RESTART].EEP = (uint32_t)&NRF_SAADC->EVENTS_END;
+  NRF_PPI->CH[PPI_CH_RESTART].TEP = (uint32_t)&NRF_SAADC->TASKS_START;
+
+  NRF_PPI->CHENCLR = (1UL << PPI_CH_CLOCK) | (1UL << PPI_CH_RESTART);
+
+  /* Interrupt handler uses FreeRTOS API */
+  NVIC_SetPriority(SAADC_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8 - configPRIO_BITS));
   NVIC_EnableIRQ(SAADC_IRQn);
 
   return 0;
 }
 
-int riotee_adc_sample(int16_t *dst, riotee_adc_cfg_t *cfg) {
+/* Takes n_samples samples of all configured channels into dst and waits until the buffer is full. Must be called in a
+ * critical section with the SAADC enabled and configured. Leaves the critical section. Returns the notification value
+ * that ended the wait. */
+static unsigned long acquire_block(int16_t *dst, unsigned int n_channels, unsigned int n_samples,
+                                   unsigned int interval_ticks32, riotee_adc_progress_t *progress) {
   unsigned long notification_value;
 
+  /* EasyDMA fills the whole buffer, the CPU only wakes up when it is full */
+  NRF_SAADC->RESULT.PTR = (uint32_t)dst;
+  NRF_SAADC->RESULT.MAXCNT = n_channels * n_samples;
+  NRF_PPI->CHENSET = PPI_CHENSET_CH4_Msk | PPI_CHENSET_CH5_Msk;
+
+  xTaskNotifyStateClearIndexed(usr_task_handle, 1);
+
+  NRF_SAADC->EVENTS_END = 0;
+  NRF_SAADC->INTENSET = SAADC_INTENSET_END_Msk;
+  mode = ADC_MODE_SAMPLE;
+  active_progress = progress;
+
+  /* Register teardown function so runtime can abort us */
+  adc_teardown_ptr = teardown;
+
+  if (n_samples > 1)
+    sample_clock_start(interval_ticks32);
+  NRF_SAADC->TASKS_START = 1;
+
+  taskEXIT_CRITICAL();
+
+  xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+  return notification_value;
+}
+
+int riotee_adc_sample(int16_t *dst, riotee_adc_cfg_t *cfg) {
+  int rc;
+
+  if ((cfg->n_samples == 0) || (cfg->n_samples > RIOTEE_ADC_MAX_SAMPLES))
+    return ADC_ERR_GENERIC;
+  if ((cfg->n_samples > 1) && (cfg->sample_interval_ticks32 < 2))
+    return ADC_ERR_GENERIC;
+
+  RIOTEE_PROBE_START(RIOTEE_PROBE_ADC_SAMPLE);
+
   taskENTER_CRITICAL();
+  if (mode != ADC_MODE_IDLE) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_BUSY;
+  }
+
   NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Enabled << SAADC_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SAADC);
 
-  NRF_SAADC->CH[0].CONFIG = (SAADC_CH_CONFIG_RESP_Bypass << SAADC_CH_CONFIG_RESP_Pos) |
-                            (SAADC_CH_CONFIG_RESN_Bypass << SAADC_CH_CONFIG_RESN_Pos) |
-                            ((cfg->gain << SAADC_CH_CONFIG_GAIN_Pos) & SAADC_CH_CONFIG_GAIN_Msk) |
-                            ((cfg->reference << SAADC_CH_CONFIG_REFSEL_Pos) & SAADC_CH_CONFIG_REFSEL_Msk) |
-                            ((cfg->acq_time << SAADC_CH_CONFIG_TACQ_Pos) & SAADC_CH_CONFIG_TACQ_Msk);
+  configure_single(cfg);
 
-  /* If oversampling is enabled, take samples as fast as possible in burst mode */
-  NRF_SAADC->OVERSAMPLE = cfg->oversampling;
-  if (cfg->oversampling != RIOTEE_ADC_OVERSAMPLE_DISABLED)
-    NRF_SAADC->CH[0].CONFIG |= (SAADC_CH_CONFIG_BURST_Enabled << SAADC_CH_CONFIG_BURST_Pos);
+  rc = (acquire_block(dst, 1, cfg->n_samples, cfg->sample_interval_ticks32, NULL) == EVT_ADC) ? ADC_ERR_OK
+                                                                                             : ADC_ERR_GENERIC;
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_ADC_SAMPLE);
+  return rc;
+}
 
-  NRF_SAADC->CH[0].PSELP = cfg->input_pos;
-  NRF_SAADC->CH[0].PSELN = cfg->input_neg;
-  if (cfg->input_neg != RIOTEE_ADC_INPUT_NC)
-    NRF_SAADC->CH[0].CONFIG |= (SAADC_CH_CONFIG_MODE_Diff << SAADC_CH_CONFIG_MODE_Pos);
+int riotee_adc_sample_resumable(int16_t *dst, riotee_adc_cfg_t *cfg, riotee_adc_progress_t *progress) {
+  if ((cfg->n_samples == 0) || (cfg->n_samples > RIOTEE_ADC_MAX_SAMPLES))
+    return ADC_ERR_GENERIC;
+  if ((cfg->n_samples > 1) && (cfg->sample_interval_ticks32 < 2))
+    return ADC_ERR_GENERIC;
 
-  /* Take only one sample, manage buffer in software */
-  NRF_SAADC->RESULT.PTR = (uint32_t)dst;
-  NRF_SAADC->RESULT.MAXCNT = 1;
-  samples_remaining = cfg->n_samples;
+  while (progress->n_done < cfg->n_samples) {
+    if (progress->n_done == 0) {
+      progress->t_start = riotee_time_now();
+    } else {
+      /* Continue at the next sample time on the grid of the original acquisition */
+      uint64_t now = riotee_time_now();
+      uint64_t next = progress->t_start + (uint64_t)progress->n_done * cfg->sample_interval_ticks32;
+      if (next <= now) {
+        /* Samples whose time has passed are marked, so that dst[k] stays at t_start + k * interval */
+        uint64_t n_passed = (now - next) / cfg->sample_interval_ticks32 + 1;
+        unsigned int n_left = cfg->n_samples - progress->n_done;
+        unsigned int n_skip = (n_passed < n_left) ? (unsigned int)n_passed : n_left;
+        for (unsigned int i = 0; i < n_skip; i++)
+          dst[progress->n_done + i] = RIOTEE_ADC_SAMPLE_MISSING;
+        progress->n_done += n_skip;
+        progress->n_missing += n_skip;
+        if (progress->n_done == cfg->n_samples)
+          break;
+        next += (uint64_t)n_skip * cfg->sample_interval_ticks32;
+      }
+      if (riotee_sleep_until(next) != 0)
+        return ADC_ERR_GENERIC;
+    }
+
+    taskENTER_CRITICAL();
+    if (mode != ADC_MODE_IDLE) {
+      taskEXIT_CRITICAL();
+      return ADC_ERR_BUSY;
+    }
+
+    NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Enabled << SAADC_ENABLE_ENABLE_Pos);
+    acct_start(ACCT_SAADC);
+
+    configure_single(cfg);
+
+    unsigned long notification_value =
+        acquire_block(dst + progress->n_done, 1, cfg->n_samples - progress->n_done, cfg->sample_interval_ticks32,
+                      progress);
+    /* Progress was recorded by the interrupt or the teardown function, anything else is an error */
+    if ((notification_value != EVT_ADC) && (notification_value != EVT_TEARDOWN) && (notification_value != EVT_RESET))
+      return ADC_ERR_GENERIC;
+    if (notification_value != EVT_ADC)
+      progress->n_resumed++;
+  }
+  return ADC_ERR_OK;
+}
+
+int riotee_adc_scan(int16_t *dst, riotee_adc_scan_cfg_t *cfg) {
+  if ((cfg->n_channels == 0) || (cfg->n_channels > RIOTEE_ADC_MAX_CHANNELS) || (cfg->n_samples == 0))
+    return ADC_ERR_GENERIC;
+  if (cfg->n_samples * cfg->n_channels > RIOTEE_ADC_MAX_SAMPLES)
+    return ADC_ERR_GENERIC;
+  if ((cfg->n_samples > 1) && (cfg->sample_interval_ticks32 < 2))
+    return ADC_ERR_GENERIC;
+
+  taskENTER_CRITICAL();
+  if (mode != ADC_MODE_IDLE) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_BUSY;
+  }
+
+  NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Enabled << SAADC_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SAADC);
+
+  for (unsigned int i = 0; i < cfg->n_channels; i++)
+    configure_channel(i, &cfg->channels[i]);
+  disable_channels_from(cfg->n_channels);
+  /* Oversampling is not supported with more than one channel */
+  NRF_SAADC->OVERSAMPLE = RIOTEE_ADC_OVERSAMPLE_DISABLED;
+
+  if (acquire_block(dst, cfg->n_channels, cfg->n_samples, cfg->sample_interval_ticks32, NULL) != EVT_ADC)
+    return ADC_ERR_GENERIC;
+  return ADC_ERR_OK;
+}
+
+int riotee_adc_stream_start(int16_t *buf0, int16_t *buf1, unsigned int block_size, riotee_adc_cfg_t *cfg) {
+  if ((block_size == 0) || (block_size > RIOTEE_ADC_MAX_SAMPLES) || (cfg->sample_interval_ticks32 < 2))
+    return ADC_ERR_GENERIC;
+
+  taskENTER_CRITICAL();
+  if (mode != ADC_MODE_IDLE) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_BUSY;
+  }
+
+  NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Enabled << SAADC_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SAADC);
+
+  configure_single(cfg);
+
+  stream_buf[0] = buf0;
+  stream_buf[1] = buf1;
+  n_blocks_done = 0;
+  n_blocks_read = 0;
+
+  NRF_SAADC->RESULT.PTR = (uint32_t)buf0;
+  NRF_SAADC->RESULT.MAXCNT = block_size;
+  /* All samples are triggered by the sample clock and a full buffer immediately starts the next one */
+  NRF_PPI->CHENCLR = PPI_CHENCLR_CH4_Msk | PPI_CHENCLR_CH5_Msk;
+  NRF_PPI->CHENSET = (1UL << PPI_CH_RESTART);
 
   xTaskNotifyStateClearIndexed(usr_task_handle, 1);
 
-  NRF_SAADC->INTENSET = SAADC_INTENSET_END_Msk;
+  NRF_SAADC->EVENTS_END = 0;
+  NRF_SAADC->EVENTS_STARTED = 0;
+  NRF_SAADC->INTENSET = SAADC_INTENSET_END_Msk | SAADC_INTENSET_STARTED_Msk;
+  mode = ADC_MODE_STREAM;
 
-  /* Register teardown function so runtime can abort us */
   adc_teardown_ptr = teardown;
 
-  if (cfg->n_samples > 1) {
-    sample_interval_ticks32 = cfg->sample_interval_ticks32;
-    NRF_RTC0->CC[2] = (NRF_RTC0->COUNTER + cfg->sample_interval_ticks32) % (1 << 24);
-    NRF_RTC0->EVTENSET = RTC_EVTEN_COMPARE2_Msk;
+  NRF_SAADC->TASKS_START = 1;
+  sample_clock_start(cfg->sample_interval_ticks32);
+
+  taskEXIT_CRITICAL();
+  return ADC_ERR_OK;
+}
+
+int riotee_adc_stream_wait(int16_t **block) {
+  unsigned long notification_value;
+
+  for (;;) {
+    taskENTER_CRITICAL();
+    if (mode != ADC_MODE_STREAM) {
+      taskEXIT_CRITICAL();
+      return ADC_ERR_GENERIC;
+    }
+    unsigned int n_available = n_blocks_done - n_blocks_read;
+    /* EasyDMA is already writing to the buffer of the oldest block */
+    if (n_available > 1) {
+      n_blocks_read = n_blocks_done;
+      taskEXIT_CRITICAL();
+      return ADC_ERR_OVERRUN;
+    }
+    if (n_available == 1) {
+      *block = stream_buf[n_blocks_read % 2];
+      n_blocks_read++;
+      taskEXIT_CRITICAL();
+      return ADC_ERR_OK;
+    }
+    xTaskNotifyStateClearIndexed(usr_task_handle, 1);
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+    if (notification_value != EVT_ADC)
+      return ADC_ERR_GENERIC;
+  }
+}
+
+int riotee_adc_stream_stop(void) {
+  taskENTER_CRITICAL();
+  if (mode != ADC_MODE_STREAM) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_GENERIC;
   }
+  stop_sampling();
+  taskEXIT_CRITICAL();
+  return ADC_ERR_OK;
+}
+
+int riotee_adc_monitor_start(riotee_adc_cfg_t *cfg, int16_t limit_low, int16_t limit_high) {
+  if ((cfg->sample_interval_ticks32 < 2) || (limit_low > limit_high))
+    return ADC_ERR_GENERIC;
+
+  taskENTER_CRITICAL();
+  if (mode != ADC_MODE_IDLE) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_BUSY;
+  }
+
+  NRF_SAADC->ENABLE = (SAADC_ENABLE_ENABLE_Enabled << SAADC_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SAADC);
+
+  configure_single(cfg);
+  NRF_SAADC->CH[0].LIMIT = (((uint32_t)(uint16_t)limit_high) << SAADC_CH_LIMIT_HIGH_Pos) |
+                           (((uint32_t)(uint16_t)limit_low) << SAADC_CH_LIMIT_LOW_Pos);
+
+  /* Every sample overwrites the previous one and the CPU is only woken up by a limit event */
+  NRF_SAADC->RESULT.PTR = (uint32_t)&monitor_sample;
+  NRF_SAADC->RESULT.MAXCNT = 1;
+  NRF_PPI->CHENCLR = PPI_CHENCLR_CH4_Msk | PPI_CHENCLR_CH5_Msk;
+  NRF_PPI->CHENSET = (1UL << PPI_CH_RESTART);
+
+  xTaskNotifyStateClearIndexed(usr_task_handle, 1);
+
+  NRF_SAADC->EVENTS_CH[0].LIMITH = 0;
+  NRF_SAADC->EVENTS_CH[0].LIMITL = 0;
+  NRF_SAADC->INTENSET = SAADC_INTENSET_CH0LIMITH_Msk | SAADC_INTENSET_CH0LIMITL_Msk;
+  monitor_limit = RIOTEE_ADC_LIMIT_NONE;
+  mode = ADC_MODE_MONITOR;
+
+  adc_teardown_ptr = teardown;
+
   NRF_SAADC->TASKS_START = 1;
+  sample_clock_start(cfg->sample_interval_ticks32);
 
   taskEXIT_CRITICAL();
+  return ADC_ERR_OK;
+}
 
-  xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
-  if (notification_value == EVT_ADC)
-    return 0;
-  else
-    return -1;
+int riotee_adc_monitor_wait(riotee_adc_limit_t *limit, int16_t *value) {
+  unsigned long notification_value;
+
+  for (;;) {
+    taskENTER_CRITICAL();
+    if (monitor_limit != RIOTEE_ADC_LIMIT_NONE) {
+      *limit = monitor_limit;
+      if (value != NULL)
+        *value = monitor_sample;
+      monitor_limit = RIOTEE_ADC_LIMIT_NONE;
+      taskEXIT_CRITICAL();
+      return ADC_ERR_OK;
+    }
+    if (mode != ADC_MODE_MONITOR) {
+      taskEXIT_CRITICAL();
+      return ADC_ERR_GENERIC;
+    }
+    xTaskNotifyStateClearIndexed(usr_task_handle, 1);
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+    if (notification_value != EVT_ADC)
+      return ADC_ERR_GENERIC;
+  }
+}
+
+int riotee_adc_monitor_stop(void) {
+  taskENTER_CRITICAL();
+  monitor_limit = RIOTEE_ADC_LIMIT_NONE;
+  if (mode != ADC_MODE_MONITOR) {
+    taskEXIT_CRITICAL();
+    return ADC_ERR_GENERIC;
+  }
+  stop_sampling();
+  taskEXIT_CRITICAL();
+  return ADC_ERR_OK;
 }
@@ -100,10 +100,12 @@ int am1805_enable_trickle(void) {
 }
 
 int am1805_get_datetime(struct tm* t) {
+  int rc;
   uint8_t rx_buf[7];
-  memset(t, 0, sizeof(t));
+  memset(t, 0, sizeof(*t));
 
-  read_registers(rx_buf, 7, AM1805_SECOND_REG);
+  if ((rc = read_registers(rx_buf, 7, AM1805_SECOND_REG)) != 0)
+    return rc;
 
   t->tm_sec = hex2dec(rx_buf[0] & AM1805_SECOND_MSK);
   t->tm_min = hex2dec(rx_buf[1] & AM1805_MINUTE_MSK);
@@ -130,6 +132,39 @@ int am1805_set_datetime(struct tm* t) {
   return write_registers(AM1805_SECOND_REG, time_buf, sizeof(time_buf));
 }
 
+/* Number of days between 2000-01-01 and the given date. Valid for the years 2000-2099 that the AM1805 supports. */
+static uint32_t days_since_2000(unsigned int year, unsigned int month, unsigned int mday) {
+  static const uint16_t days_before_month[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+  unsigned int y = year - 2000;
+
+  /* Every fourth year is a leap year in this range, starting with 2000 */
+  uint32_t days = y * 365 + (y + 3) / 4 + days_before_month[month - 1] + mday - 1;
+  if ((month > 2) && (y % 4 == 0))
+    days++;
+  return days;
+}
+
+int am1805_get_timestamp(uint64_t* hundredths) {
+  int rc;
+  uint8_t rx_buf[7];
+
+  /* Read hundredths up to year in one transfer, the AM1805 keeps them consistent while reading */
+  if ((rc = read_registers(rx_buf, 7, AM1805_HUNDRETH_REG)) != 0)
+    return rc;
+
+  unsigned int month = hex2dec(rx_buf[5] & AM1805_MONTH_MSK);
+  if ((month < 1) || (month > 12))
+    return -1;
+
+  uint32_t days = days_since_2000(2000 + hex2dec(rx_buf[6] & AM1805_YEAR_MSK), month,
+                                  hex2dec(rx_buf[4] & AM1805_DATE_MSK));
+  uint32_t seconds = hex2dec(rx_buf[3] & AM1805_HOUR_24_MSK) * 3600 + hex2dec(rx_buf[2] & AM1805_MINUTE_MSK) * 60 +
+                     hex2dec(rx_buf[1] & AM1805_SECOND_MSK);
+
+  *hundredths = ((uint64_t)days * 86400 + seconds) * 100 + hex2dec(rx_buf[0]);
+  return 0;
+}
+
 int am1805_get_hundredths(unsigned int* hundredths) {
   int rc;
   uint8_t rx_buf;
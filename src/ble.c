@@ -14,6 +14,7 @@
 #include "semphr.h"
 
 #include "runtime.h"
+#include "riotee_probe.h"
 
 /* Bluetooth Core Spec 5.2 Section 2.1.2 */
 #define ADV_CHANNEL_AA 0x8E89BED6
@@ -49,8 +50,14 @@ static __inline int8_t ch2freq(uint8_t ch) {
   }
 }
 
+/* Time the radio is on for one advertising packet: ramp-up, preamble, access address, header, payload and CRC */
+static inline unsigned int adv_airtime_us(void) {
+  return 40 + (1 + 4 + 2 + adv_pkt.header.len + 3) * 8;
+}
+
 void teardown(void) {
   radio_stop();
+  acct_stop(ACCT_HFXO_BLE);
   teardown_ptr = NULL;
   xTaskNotifyIndexed(usr_task_handle, 1, EVT_TEARDOWN, eSetBits);
 }
@@ -97,6 +104,7 @@ static inline int set_channel(unsigned int adv_ch_idx) {
 
 int riotee_ble_advertise(void *data, riotee_adv_ch_t ch) {
   unsigned long notification_value;
+  RIOTEE_PROBE_START(RIOTEE_PROBE_BLE_ADVERTISE);
 
   taskENTER_CRITICAL();
   if (ch == ADV_CH_ALL) {
@@ -112,6 +120,7 @@ int riotee_ble_advertise(void *data, riotee_adv_ch_t ch) {
   set_channel(current_adv_ch_idx);
 
   memcpy(adv_data_address, data, adv_data_len);
+  acct_start(ACCT_HFXO_BLE);
   radio_start();
   xTaskNotifyStateClearIndexed(usr_task_handle, 1);
 
@@ -119,6 +128,7 @@ int riotee_ble_advertise(void *data, riotee_adv_ch_t ch) {
   teardown_ptr = teardown;
   taskEXIT_CRITICAL();
   xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_BLE_ADVERTISE);
   if (notification_value != EVT_BLE)
     return -1;
 
@@ -129,12 +139,14 @@ int riotee_ble_advertise(void *data, riotee_adv_ch_t ch) {
 void radio_disabled_callback() {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+  acct_add_us(ACCT_RADIO_TX, adv_airtime_us());
   /* If we still have channels to advertise on */
   if (current_adv_ch_idx > 0) {
     set_channel(--current_adv_ch_idx);
     NRF_RADIO->TASKS_TXEN = 1;
   } else {
     NRF_CLOCK->TASKS_HFCLKSTOP = 1;
+    acct_stop(ACCT_HFXO_BLE);
     /* Unregister teardown function */
     teardown_ptr = NULL;
     xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_BLE, eSetBits, &xHigherPriorityTaskWoken);
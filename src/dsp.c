@@ -0,0 +1,244 @@
+#include <math.h>
+#include <string.h>
+
+#include "riotee_dsp.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "nrf.h"
+#else
+/* Plain C versions of the Cortex-M4 DSP instructions used below, e.g. for host builds */
+static inline uint64_t __SMLALD(uint32_t x, uint32_t y, uint64_t acc) {
+  return acc + (int64_t)((int16_t)x * (int16_t)y) + (int64_t)((int16_t)(x >> 16) * (int16_t)(y >> 16));
+}
+static inline uint32_t __SMUSD(uint32_t x, uint32_t y) {
+  return (uint32_t)((int16_t)x * (int16_t)y - (int16_t)(x >> 16) * (int16_t)(y >> 16));
+}
+static inline uint32_t __SMUADX(uint32_t x, uint32_t y) {
+  return (uint32_t)((int16_t)x * (int16_t)(y >> 16) + (int16_t)(x >> 16) * (int16_t)y);
+}
+static inline uint32_t __SHADD16(uint32_t x, uint32_t y) {
+  return (((uint32_t)(((int16_t)x + (int16_t)y) >> 1)) & 0xFFFF) |
+         ((uint32_t)(((int16_t)(x >> 16) + (int16_t)(y >> 16)) >> 1) << 16);
+}
+static inline uint32_t __SHSUB16(uint32_t x, uint32_t y) {
+  return (((uint32_t)(((int16_t)x - (int16_t)y) >> 1)) & 0xFFFF) |
+         ((uint32_t)(((int16_t)(x >> 16) - (int16_t)(y >> 16)) >> 1) << 16);
+}
+static inline uint32_t __RBIT(uint32_t x) {
+  uint32_t r = 0;
+  for (unsigned int i = 0; i < 32; i++, x >>= 1)
+    r = (r << 1) | (x & 1);
+  return r;
+}
+#define __PKHBT(a, b, s) ((((uint32_t)(a)) & 0x0000FFFFUL) | ((((uint32_t)(b)) << (s)) & 0xFFFF0000UL))
+#endif
+
+static inline int16_t sat16(int64_t x) {
+  if (x > INT16_MAX)
+    return INT16_MAX;
+  if (x < INT16_MIN)
+    return INT16_MIN;
+  return (int16_t)x;
+}
+
+int riotee_fir_init(riotee_fir_t *fir, const int16_t *coeffs, unsigned int n_taps, int16_t *state,
+                    unsigned int decimation) {
+  if ((n_taps == 0) || (decimation == 0))
+    return DSP_ERR_GENERIC;
+
+  fir->coeffs = coeffs;
+  fir->state = state;
+  fir->n_taps = n_taps;
+  fir->decimation = decimation;
+  riotee_fir_reset(fir);
+  return DSP_ERR_OK;
+}
+
+void riotee_fir_reset(riotee_fir_t *fir) {
+  memset(fir->state, 0, 2 * fir->n_taps * sizeof(int16_t));
+  fir->pos = 0;
+  fir->phase = 0;
+}
+
+/* Dot product of the newest-first window and the coefficients, two taps per instruction */
+static int16_t fir_dot(const int16_t *window, const int16_t *coeffs, unsigned int n_taps) {
+  uint64_t acc = 0;
+  uint32_t x, c;
+  unsigned int k = 0;
+
+  for (; k + 2 <= n_taps; k += 2) {
+    /* Unaligned word access is fine on the Cortex-M4 */
+    memcpy(&x, &window[k], sizeof(x));
+    memcpy(&c, &coeffs[k], sizeof(c));
+    acc = __SMLALD(x, c, acc);
+  }
+  if (k < n_taps)
+    acc += (int64_t)window[k] * coeffs[k];
+
+  return sat16(((int64_t)acc + (1 << 14)) >> 15);
+}
+
+unsigned int riotee_fir_process(riotee_fir_t *fir, int16_t *dst, const int16_t *src, unsigned int n) {
+  const unsigned int n_taps = fir->n_taps;
+  unsigned int n_out = 0;
+
+  for (unsigned int i = 0; i < n; i++) {
+    /* Newest sample goes in front of the previous one */
+    fir->pos = (fir->pos == 0) ? n_taps - 1 : fir->pos - 1;
+    fir->state[fir->pos] = src[i];
+    fir->state[fir->pos + n_taps] = src[i];
+
+    if (++fir->phase < fir->decimation)
+      continue;
+    fir->phase = 0;
+    /* Output index never overtakes the input index, so filtering in place is safe */
+    dst[n_out++] = fir_dot(&fir->state[fir->pos], fir->coeffs, n_taps);
+  }
+  return n_out;
+}
+
+int riotee_iir_init(riotee_iir_t *iir, riotee_biquad_t *stages, const riotee_biquad_coeffs_t *coeffs,
+                    unsigned int n_stages) {
+  if (n_stages == 0)
+    return DSP_ERR_GENERIC;
+  /* -2.0 has no negation in Q14 */
+  for (unsigned int i = 0; i < n_stages; i++) {
+    if ((coeffs[i].a1 == INT16_MIN) || (coeffs[i].a2 == INT16_MIN))
+      return DSP_ERR_GENERIC;
+  }
+
+  iir->stages = stages;
+  iir->n_stages = n_stages;
+  for (unsigned int i = 0; i < n_stages; i++) {
+    /* Feedback coefficients are negated, so that all terms are accumulated */
+    stages[i].b0_b1 = __PKHBT(coeffs[i].b0, coeffs[i].b1, 16);
+    stages[i].b2_na1 = __PKHBT(coeffs[i].b2, -coeffs[i].a1, 16);
+    stages[i].na2 = (uint16_t)(-coeffs[i].a2);
+  }
+  riotee_iir_reset(iir);
+  return DSP_ERR_OK;
+}
+
+void riotee_iir_reset(riotee_iir_t *iir) {
+  for (unsigned int i = 0; i < iir->n_stages; i++) {
+    iir->stages[i].x1 = 0;
+    iir->stages[i].x2 = 0;
+    iir->stages[i].y1 = 0;
+    iir->stages[i].y2 = 0;
+  }
+}
+
+void riotee_iir_process(riotee_iir_t *iir, int16_t *dst, const int16_t *src, unsigned int n) {
+  if (dst != src)
+    memcpy(dst, src, n * sizeof(int16_t));
+
+  /* One stage at a time over the whole block keeps the coefficients and state of a stage in registers */
+  for (unsigned int s = 0; s < iir->n_stages; s++) {
+    riotee_biquad_t *bq = &iir->stages[s];
+    int16_t x1 = bq->x1, x2 = bq->x2, y1 = bq->y1, y2 = bq->y2;
+
+    for (unsigned int i = 0; i < n; i++) {
+      int16_t x0 = dst[i];
+      uint64_t acc = __SMLALD(__PKHBT(x0, x1, 16), bq->b0_b1, 0);
+      acc = __SMLALD(__PKHBT(x2, y1, 16), bq->b2_na1, acc);
+      acc = __SMLALD((uint16_t)y2, bq->na2, acc);
+      int16_t y0 = sat16(((int64_t)acc + (1 << 13)) >> 14);
+
+      x2 = x1;
+      x1 = x0;
+      y2 = y1;
+      y1 = y0;
+      dst[i] = y0;
+    }
+    bq->x1 = x1;
+    bq->x2 = x2;
+    bq->y1 = y1;
+    bq->y2 = y2;
+  }
+}
+
+void riotee_fft_twiddle_init(int16_t *twiddle, unsigned int log2n) {
+  const unsigned int n = 1U << log2n;
+
+  for (unsigned int k = 0; k < n / 2; k++) {
+    float phi = 2.0f * (float)M_PI * k / n;
+    twiddle[2 * k] = (int16_t)(cosf(phi) * 32767.0f);
+    twiddle[2 * k + 1] = (int16_t)(-sinf(phi) * 32767.0f);
+  }
+}
+
+int riotee_fft_init(riotee_fft_t *fft, int16_t *data, const int16_t *twiddle, unsigned int log2n) {
+  if ((log2n == 0) || (log2n > RIOTEE_FFT_MAX_LOG2N))
+    return DSP_ERR_GENERIC;
+
+  fft->data = data;
+  fft->twiddle = twiddle;
+  fft->log2n = log2n;
+  fft->stage = 0;
+  fft->index = 0;
+  return DSP_ERR_OK;
+}
+
+/* Swaps element i with its bit-reversed counterpart */
+static inline void fft_bitrev(riotee_fft_t *fft, unsigned int i) {
+  unsigned int j = __RBIT(i) >> (32 - fft->log2n);
+  if (i < j) {
+    uint32_t *x = (uint32_t *)fft->data;
+    uint32_t tmp = x[i];
+    x[i] = x[j];
+    x[j] = tmp;
+  }
+}
+
+/* Butterfly b of the given stage (1..log2n). Both outputs are scaled by 1/2 to avoid overflow. */
+static inline void fft_butterfly(riotee_fft_t *fft, unsigned int stage, unsigned int b) {
+  const unsigned int half = 1U << (stage - 1);
+  const unsigned int j = b & (half - 1);
+  const unsigned int i0 = ((b >> (stage - 1)) << stage) + j;
+  uint32_t *x = (uint32_t *)fft->data;
+  uint32_t w;
+
+  memcpy(&w, &fft->twiddle[2 * (j << (fft->log2n - stage))], sizeof(w));
+
+  uint32_t a = x[i0];
+  uint32_t c = x[i0 + half];
+  /* t = c * w, real part in the bottom and imaginary part in the top halfword */
+  int32_t tr = (int32_t)__SMUSD(c, w) >> 15;
+  int32_t ti = (int32_t)__SMUADX(c, w) >> 15;
+  uint32_t t = __PKHBT(tr, ti, 16);
+
+  x[i0] = __SHADD16(a, t);
+  x[i0 + half] = __SHSUB16(a, t);
+}
+
+bool riotee_fft_step(riotee_fft_t *fft, unsigned int max_ops) {
+  const unsigned int n = 1U << fft->log2n;
+
+  while (max_ops > 0) {
+    if (fft->stage > fft->log2n)
+      return true;
+
+    /* Stage 0 is the bit reversal with one operation per element, all other stages have n/2 butterflies */
+    unsigned int n_ops = (fft->stage == 0) ? n : n / 2;
+    unsigned int end = fft->index + max_ops;
+    if (end > n_ops)
+      end = n_ops;
+    max_ops -= end - fft->index;
+
+    if (fft->stage == 0) {
+      for (unsigned int i = fft->index; i < end; i++)
+        fft_bitrev(fft, i);
+    } else {
+      for (unsigned int b = fft->index; b < end; b++)
+        fft_butterfly(fft, fft->stage, b);
+    }
+
+    if (end == n_ops) {
+      fft->stage++;
+      fft->index = 0;
+    } else {
+      fft->index = end;
+    }
+  }
+  return fft->stage > fft->log2n;
+}
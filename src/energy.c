@@ -0,0 +1,116 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "printf.h"
+#include "runtime.h"
+#include "riotee_adc.h"
+#include "riotee_energy.h"
+
+/* This file is not excluded in linker.ld, so the table lives in retained memory and is part of every checkpoint */
+static riotee_energy_entry_t table[RIOTEE_ENERGY_N_ENTRIES];
+static float cap_uf = RIOTEE_ENERGY_CAP_UF;
+
+/* Internal reference is independent of VDD. Oversampling reduces noise of the voltage difference. */
+static riotee_adc_cfg_t vcap_cfg = {.gain = RIOTEE_ADC_GAIN1_6,
+                                    .reference = RIOTEE_ADC_REFERENCE_INTERNAL,
+                                    .acq_time = RIOTEE_ADC_ACQTIME_10US,
+                                    .input_pos = RIOTEE_ADC_INPUT_VCAP,
+                                    .input_neg = RIOTEE_ADC_INPUT_NC,
+                                    .oversampling = RIOTEE_ADC_OVERSAMPLE_16X,
+                                    .n_samples = 1};
+
+static int read_vcap(float *dst) {
+  int16_t adc_res;
+  int rc;
+
+  if ((rc = riotee_adc_sample(&adc_res, &vcap_cfg)) != 0)
+    return rc;
+  *dst = riotee_adc_vadc2vcap(riotee_adc_adc2vadc(adc_res, &vcap_cfg));
+  return 0;
+}
+
+static riotee_energy_entry_t *find_entry(const char *name, bool create) {
+  for (unsigned int i = 0; i < RIOTEE_ENERGY_N_ENTRIES; i++) {
+    if (table[i].name == NULL) {
+      if (!create)
+        return NULL;
+      table[i].name = name;
+      table[i].energy_min_uj = 1e30f;
+      table[i].energy_max_uj = -1e30f;
+      return &table[i];
+    }
+    if (strcmp(table[i].name, name) == 0)
+      return &table[i];
+  }
+  return NULL;
+}
+
+void riotee_energy_set_capacitance(float capacitance_uf) {
+  cap_uf = capacitance_uf;
+}
+
+int riotee_energy_start(riotee_energy_meas_t *meas) {
+  meas->n_turnoff = runtime_stats.n_turnoff;
+  meas->n_reset = runtime_stats.n_reset;
+  /* Sample last, so the ADC conversion is not counted */
+  if (read_vcap(&meas->v_start) != 0)
+    return ENERGY_ERR_GENERIC;
+  return ENERGY_ERR_OK;
+}
+
+int riotee_energy_stop(riotee_energy_meas_t *meas, const char *name, float *energy_uj) {
+  riotee_energy_entry_t *entry;
+  float v_end;
+
+  /* Sample first, so the table lookup is not counted */
+  int rc = read_vcap(&v_end);
+
+  if ((entry = find_entry(name, true)) == NULL)
+    return ENERGY_ERR_FULL;
+
+  /* Capacitor may have been recharged in between */
+  if ((rc != 0) || (runtime_stats.n_turnoff != meas->n_turnoff) || (runtime_stats.n_reset != meas->n_reset)) {
+    entry->n_discarded++;
+    return ENERGY_ERR_DISCARDED;
+  }
+
+  float e_uj = 0.5f * cap_uf * (meas->v_start * meas->v_start - v_end * v_end);
+
+  entry->n_calls++;
+  entry->energy_sum_uj += e_uj;
+  if (e_uj < entry->energy_min_uj)
+    entry->energy_min_uj = e_uj;
+  if (e_uj > entry->energy_max_uj)
+    entry->energy_max_uj = e_uj;
+
+  if (energy_uj != NULL)
+    *energy_uj = e_uj;
+  return ENERGY_ERR_OK;
+}
+
+const riotee_energy_entry_t *riotee_energy_get(const char *name) {
+  return find_entry(name, false);
+}
+
+const riotee_energy_entry_t *riotee_energy_get_idx(unsigned int idx) {
+  if ((idx >= RIOTEE_ENERGY_N_ENTRIES) || (table[idx].name == NULL))
+    return NULL;
+  return &table[idx];
+}
+
+void riotee_energy_reset(void) {
+  memset(table, 0, sizeof(table));
+}
+
+void riotee_energy_dump(void) {
+  const riotee_energy_entry_t *entry;
+
+  for (unsigned int i = 0; (entry = riotee_energy_get_idx(i)) != NULL; i++) {
+    if (entry->n_calls == 0) {
+      printf("ENERGY %s n=0 discarded=%u\r\n", entry->name, entry->n_discarded);
+      continue;
+    }
+    printf("ENERGY %s n=%u discarded=%u min_uj=%.2f avg_uj=%.2f max_uj=%.2f\r\n", entry->name, entry->n_calls,
+           entry->n_discarded, entry->energy_min_uj, entry->energy_sum_uj / entry->n_calls, entry->energy_max_uj);
+  }
+}
@@ -0,0 +1,53 @@
+#include <math.h>
+#include <string.h>
+
+#include "riotee_gate.h"
+#include "riotee_timing.h"
+
+void riotee_gate_init(riotee_gate_t *gate, const riotee_gate_cfg_t *cfg) {
+  memset(gate, 0, sizeof(riotee_gate_t));
+  gate->cfg = *cfg;
+}
+
+void riotee_gate_reset(riotee_gate_t *gate) {
+  gate->has_passed = false;
+}
+
+static riotee_gate_result_t decide(riotee_gate_t *gate, float value, uint64_t now) {
+  if (!gate->has_passed)
+    return RIOTEE_GATE_FIRST;
+
+  if (fabsf(value - gate->last_passed) > gate->cfg.deadband)
+    return RIOTEE_GATE_DEADBAND;
+
+  /* Measured against the previous reading, so a fast change is caught while it is still within the deadband */
+  if ((gate->cfg.max_rate_per_s > 0.0f) && (now > gate->t_prev)) {
+    float dt_s = (float)(now - gate->t_prev) / 32768.0f;
+    if (fabsf(value - gate->prev) > gate->cfg.max_rate_per_s * dt_s)
+      return RIOTEE_GATE_RATE;
+  }
+
+  if ((gate->cfg.heartbeat_ticks > 0) && (now - gate->t_passed >= gate->cfg.heartbeat_ticks))
+    return RIOTEE_GATE_HEARTBEAT;
+
+  return RIOTEE_GATE_SUPPRESS;
+}
+
+riotee_gate_result_t riotee_gate_check(riotee_gate_t *gate, float value) {
+  uint64_t now = riotee_time_now();
+  riotee_gate_result_t res = decide(gate, value, now);
+
+  gate->prev = value;
+  gate->t_prev = now;
+
+  if (res == RIOTEE_GATE_SUPPRESS) {
+    gate->n_suppressed++;
+    return res;
+  }
+
+  gate->last_passed = value;
+  gate->t_passed = now;
+  gate->has_passed = true;
+  gate->n_passed++;
+  return res;
+}
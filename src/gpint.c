@@ -1,3 +1,4 @@
+#include <stdbool.h>
 #include <stdlib.h>
 #include "nrf.h"
 #include "nrf_gpio.h"
@@ -6,22 +7,53 @@
 #include "runtime.h"
 #include "riotee_gpint.h"
 
-static GPINT_CALLBACK registry[32] = {0};
+#define N_PORTS 2
 
-void GPIOTE_IRQHandler(void) {
-  if (NRF_GPIOTE->EVENTS_PORT == 1) {
-    for (uint32_t i = 0; i < 32; i++) {
-      GPINT_CALLBACK cb = registry[i];
-      NRF_GPIO_Type *reg = nrf_gpio_pin_port_decode(&i);
-      if ((cb != NULL) && (reg->LATCH & (1 << i))) {
-        riotee_gpint_unregister(i);
-        reg->LATCH |= (1 << i);
-        NRF_GPIOTE->EVENTS_PORT = 0;
-        cb(i);
-        return;
-      }
-    }
+static NRF_GPIO_Type *const ports[N_PORTS] = {NRF_P0, NRF_P1};
+
+/* Indexed by absolute pin number, i.e. 32 * port + pin */
+static GPINT_CALLBACK registry[NUMBER_OF_PINS] = {0};
+
+/* Handles all latched pins of one port. Returns true if any pin was latched. */
+static bool dispatch_port(unsigned int port) {
+  NRF_GPIO_Type *reg = ports[port];
+  uint32_t latch = reg->LATCH;
+
+  if (latch == 0)
+    return false;
+
+  while (latch) {
+    /* Lowest pin first */
+    unsigned int i = __CLZ(__RBIT(latch));
+    unsigned int pin = 32 * port + i;
+    latch &= ~(1UL << i);
+
+    GPINT_CALLBACK cb = (pin < NUMBER_OF_PINS) ? registry[pin] : NULL;
+    /* Sense must be disabled before the latch can be cleared */
+    reg->PIN_CNF[i] &= ~GPIO_PIN_CNF_SENSE_Msk;
+    if (pin < NUMBER_OF_PINS)
+      registry[pin] = NULL;
+    reg->LATCH = (1UL << i);
+
+    if (cb != NULL)
+      cb(pin);
   }
+  return true;
+}
+
+void GPIOTE_IRQHandler(void) {
+  if (NRF_GPIOTE->EVENTS_PORT == 0)
+    return;
+  NRF_GPIOTE->EVENTS_PORT = 0;
+
+  /* A pin that latches while others are still latched does not generate a new PORT event, so repeat until all
+   * latches are clear. */
+  bool pending;
+  do {
+    pending = false;
+    for (unsigned int port = 0; port < N_PORTS; port++)
+      pending |= dispatch_port(port);
+  } while (pending);
 }
 
 int riotee_gpint_init(void) {
@@ -30,40 +62,43 @@ int riotee_gpint_init(void) {
   NRF_GPIOTE->EVENTS_PORT = 0;
 
   NRF_GPIOTE->INTENSET = GPIOTE_INTENSET_PORT_Msk;
+  /* Highest priority that may use the FreeRTOS API, callbacks notify tasks */
+  NVIC_SetPriority(GPIOTE_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8 - configPRIO_BITS));
   NVIC_EnableIRQ(GPIOTE_IRQn);
-  NVIC_SetPriority(GPIOTE_IRQn, 1);
   return 0;
 }
 
 int riotee_gpint_register(uint32_t pin, gpint_level_t level, riotee_gpio_pin_pull_t pull, GPINT_CALLBACK cb) {
-  NRF_GPIO_Type *reg = nrf_gpio_pin_port_decode(&pin);
-
-  if (pin > 31)
+  if ((pin >= NUMBER_OF_PINS) || !nrf_gpio_pin_present_check(pin))
     return GPINT_ERR_UNSUPPORTED;
 
   if (registry[pin] != NULL)
     return GPINT_ERR_BUSY;
   registry[pin] = cb;
 
-  reg->PIN_CNF[pin] = (GPIO_PIN_CNF_INPUT_Connect << GPIO_PIN_CNF_INPUT_Pos) | (pull << GPIO_PIN_CNF_PULL_Pos);
-  reg->LATCH |= (1 << pin);
+  uint32_t pin_no = pin;
+  NRF_GPIO_Type *reg = nrf_gpio_pin_port_decode(&pin_no);
+
+  reg->PIN_CNF[pin_no] = (GPIO_PIN_CNF_INPUT_Connect << GPIO_PIN_CNF_INPUT_Pos) | (pull << GPIO_PIN_CNF_PULL_Pos);
+  reg->LATCH = (1UL << pin_no);
 
   /* Order is important, see nrf52833 errata 210*/
   if (level == GPINT_LEVEL_HIGH) {
-    reg->PIN_CNF[pin] |= (GPIO_PIN_CNF_SENSE_High << GPIO_PIN_CNF_SENSE_Pos);
+    reg->PIN_CNF[pin_no] |= (GPIO_PIN_CNF_SENSE_High << GPIO_PIN_CNF_SENSE_Pos);
   } else {
-    reg->PIN_CNF[pin] |= (GPIO_PIN_CNF_SENSE_Low << GPIO_PIN_CNF_SENSE_Pos);
+    reg->PIN_CNF[pin_no] |= (GPIO_PIN_CNF_SENSE_Low << GPIO_PIN_CNF_SENSE_Pos);
   }
   return GPINT_ERR_OK;
 }
 
 int riotee_gpint_unregister(uint32_t pin) {
-  if (registry[pin] == NULL)
+  if ((pin >= NUMBER_OF_PINS) || (registry[pin] == NULL))
     return GPINT_ERR_GENERIC;
 
-  NRF_GPIO_Type *reg = nrf_gpio_pin_port_decode(&pin);
+  uint32_t pin_no = pin;
+  NRF_GPIO_Type *reg = nrf_gpio_pin_port_decode(&pin_no);
 
-  reg->PIN_CNF[pin] &= ~GPIO_PIN_CNF_SENSE_Msk;
+  reg->PIN_CNF[pin_no] &= ~GPIO_PIN_CNF_SENSE_Msk;
 
   registry[pin] = NULL;
   return GPINT_ERR_OK;
@@ -42,6 +42,7 @@ int riotee_i2c_write(uint8_t dev_addr, uint8_t *data, size_t n_data) {
   taskENTER_CRITICAL();
 
   NRF_TWIM1->ENABLE = TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos;
+  acct_start(ACCT_TWIM);
   NRF_TWIM1->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
 
   NRF_TWIM1->ADDRESS = dev_addr;
@@ -59,6 +60,7 @@ int riotee_i2c_write(uint8_t dev_addr, uint8_t *data, size_t n_data) {
     enter_low_power();
   }
   NRF_TWIM1->ENABLE = TWIM_ENABLE_ENABLE_Disabled << TWIM_ENABLE_ENABLE_Pos;
+  acct_stop(ACCT_TWIM);
   taskEXIT_CRITICAL();
 
   return twi_status;
@@ -67,6 +69,7 @@ int riotee_i2c_write(uint8_t dev_addr, uint8_t *data, size_t n_data) {
 int riotee_i2c_read(uint8_t *buffer, size_t n_data, uint8_t dev_addr) {
   taskENTER_CRITICAL();
   NRF_TWIM1->ENABLE = TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos;
+  acct_start(ACCT_TWIM);
 
   NRF_TWIM1->ADDRESS = dev_addr;
 
@@ -84,6 +87,7 @@ int riotee_i2c_read(uint8_t *buffer, size_t n_data, uint8_t dev_addr) {
     enter_low_power();
   }
   NRF_TWIM1->ENABLE = TWIM_ENABLE_ENABLE_Disabled << TWIM_ENABLE_ENABLE_Pos;
+  acct_stop(ACCT_TWIM);
   taskEXIT_CRITICAL();
 
   return twi_status;
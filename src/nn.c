@@ -0,0 +1,238 @@
+#include <math.h>
+#include <string.h>
+
+#include "riotee_nn.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "nrf.h"
+#else
+/* Plain C versions of the Cortex-M4 DSP instructions used below, e.g. for host builds */
+static inline uint32_t __ROR(uint32_t x, uint32_t n) {
+  return (x >> n) | (x << (32 - n));
+}
+static inline uint32_t __SXTB16(uint32_t x) {
+  return ((uint32_t)(uint16_t)(int16_t)(int8_t)x) | ((uint32_t)(uint16_t)(int16_t)(int8_t)(x >> 16) << 16);
+}
+static inline uint32_t __SADD16(uint32_t x, uint32_t y) {
+  return ((uint32_t)(uint16_t)((int16_t)x + (int16_t)y)) | ((uint32_t)(uint16_t)((int16_t)(x >> 16) + (int16_t)(y >> 16))
+                                                             << 16);
+}
+static inline uint32_t __SMLAD(uint32_t x, uint32_t y, uint32_t acc) {
+  return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
+#endif
+
+static inline int32_t clamp(int32_t x, int32_t min, int32_t max) {
+  return (x < min) ? min : ((x > max) ? max : x);
+}
+
+void riotee_nn_quantize_scale(float scale, int32_t *multiplier, int32_t *shift) {
+  int exp;
+  /* scale = q * 2^exp with 0.5 <= q < 1 */
+  float q = frexpf(scale, &exp);
+  int64_t m = (int64_t)roundf(q * (float)(1LL << 31));
+  if (m == (1LL << 31)) {
+    m /= 2;
+    exp++;
+  }
+  *multiplier = (int32_t)m;
+  *shift = -exp;
+}
+
+static inline int8_t requantize(const riotee_nn_layer_t *l, int32_t acc) {
+  int total = 31 + l->shift;
+  int64_t p = (int64_t)acc * l->multiplier;
+  if (total > 0)
+    p = (p + (1LL << (total - 1))) >> total;
+  else
+    p <<= -total;
+  return (int8_t)clamp((int32_t)p + l->out_offset, l->act_min, l->act_max);
+}
+
+/* Sum of (x[i] + x_offset) * w[i], four elements at a time with two dual 16-bit multiply-accumulates */
+static int32_t dot_s8(const int8_t *x, const int8_t *w, unsigned int n, int32_t x_offset, int32_t acc) {
+  const uint32_t offset = ((uint32_t)(uint16_t)x_offset << 16) | (uint16_t)x_offset;
+  unsigned int i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    uint32_t xv, wv;
+    /* Unaligned word access is fine on the Cortex-M4 */
+    memcpy(&xv, &x[i], sizeof(xv));
+    memcpy(&wv, &w[i], sizeof(wv));
+    /* Bytes 0 and 2 and bytes 1 and 3, sign-extended to halfwords */
+    uint32_t x02 = __SADD16(__SXTB16(xv), offset);
+    uint32_t x13 = __SADD16(__SXTB16(__ROR(xv, 8)), offset);
+    acc = (int32_t)__SMLAD(x02, __SXTB16(wv), (uint32_t)acc);
+    acc = (int32_t)__SMLAD(x13, __SXTB16(__ROR(wv, 8)), (uint32_t)acc);
+  }
+  for (; i < n; i++)
+    acc += (x[i] + x_offset) * w[i];
+  return acc;
+}
+
+void riotee_nn_conv2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                      unsigned int row_end) {
+  const unsigned int in_c = l->in.c;
+  const unsigned int filter_size = l->kernel_h * l->kernel_w * in_c;
+
+  for (unsigned int oy = row_start; oy < row_end; oy++) {
+    for (unsigned int ox = 0; ox < l->out.w; ox++) {
+      int8_t *dst = &out[(oy * l->out.w + ox) * l->out.c];
+      for (unsigned int oc = 0; oc < l->out.c; oc++) {
+        const int8_t *filter = &l->weights[oc * filter_size];
+        int32_t acc = (l->bias != NULL) ? l->bias[oc] : 0;
+
+        for (unsigned int ky = 0; ky < l->kernel_h; ky++) {
+          int iy = (int)(oy * l->stride + ky) - l->pad;
+          /* Padding is the input zero point and contributes nothing */
+          if ((iy < 0) || (iy >= l->in.h))
+            continue;
+          for (unsigned int kx = 0; kx < l->kernel_w; kx++) {
+            int ix = (int)(ox * l->stride + kx) - l->pad;
+            if ((ix < 0) || (ix >= l->in.w))
+              continue;
+            acc = dot_s8(&in[(iy * l->in.w + ix) * in_c], &filter[(ky * l->kernel_w + kx) * in_c], in_c, l->in_offset,
+                         acc);
+          }
+        }
+        dst[oc] = requantize(l, acc);
+      }
+    }
+  }
+}
+
+void riotee_nn_dense(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                     unsigned int row_end) {
+  const unsigned int n_in = l->in.h * l->in.w * l->in.c;
+
+  for (unsigned int o = row_start; o < row_end; o++) {
+    int32_t acc = (l->bias != NULL) ? l->bias[o] : 0;
+    acc = dot_s8(in, &l->weights[o * n_in], n_in, l->in_offset, acc);
+    out[o] = requantize(l, acc);
+  }
+}
+
+void riotee_nn_maxpool2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                         unsigned int row_end) {
+  const unsigned int c = l->in.c;
+
+  for (unsigned int oy = row_start; oy < row_end; oy++) {
+    for (unsigned int ox = 0; ox < l->out.w; ox++) {
+      int8_t *dst = &out[(oy * l->out.w + ox) * c];
+      memcpy(dst, &in[((oy * l->stride) * l->in.w + ox * l->stride) * c], c);
+
+      for (unsigned int ky = 0; ky < l->kernel_h; ky++) {
+        for (unsigned int kx = 0; kx < l->kernel_w; kx++) {
+          const int8_t *src = &in[((oy * l->stride + ky) * l->in.w + ox * l->stride + kx) * c];
+          unsigned int i = 0;
+#if defined(__ARM_FEATURE_DSP)
+          /* Four channels at a time: SSUB8 sets the GE flags of the lanes where dst >= src, SEL picks those lanes */
+          for (; i + 4 <= c; i += 4) {
+            uint32_t a, b;
+            memcpy(&a, &dst[i], sizeof(a));
+            memcpy(&b, &src[i], sizeof(b));
+            (void)__SSUB8(a, b);
+            a = __SEL(a, b);
+            memcpy(&dst[i], &a, sizeof(a));
+          }
+#endif
+          for (; i < c; i++) {
+            if (src[i] > dst[i])
+              dst[i] = src[i];
+          }
+        }
+      }
+      for (unsigned int i = 0; i < c; i++)
+        dst[i] = (int8_t)clamp(dst[i], l->act_min, l->act_max);
+    }
+  }
+}
+
+void riotee_nn_avgpool2d(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int row_start,
+                         unsigned int row_end) {
+  const unsigned int c = l->in.c;
+  const int32_t n = l->kernel_h * l->kernel_w;
+
+  for (unsigned int oy = row_start; oy < row_end; oy++) {
+    for (unsigned int ox = 0; ox < l->out.w; ox++) {
+      for (unsigned int ch = 0; ch < c; ch++) {
+        int32_t sum = 0;
+        for (unsigned int ky = 0; ky < l->kernel_h; ky++) {
+          for (unsigned int kx = 0; kx < l->kernel_w; kx++)
+            sum += in[((oy * l->stride + ky) * l->in.w + ox * l->stride + kx) * c + ch];
+        }
+        /* Round to nearest */
+        sum = (sum >= 0) ? (sum + n / 2) / n : (sum - n / 2) / n;
+        out[(oy * l->out.w + ox) * c + ch] = (int8_t)clamp(sum, l->act_min, l->act_max);
+      }
+    }
+  }
+}
+
+int riotee_nn_init(riotee_nn_t *nn, const riotee_nn_layer_t *layers, unsigned int n_layers, int8_t *buf0,
+                   int8_t *buf1) {
+  if (n_layers == 0)
+    return NN_ERR_GENERIC;
+
+  nn->layers = layers;
+  nn->n_layers = n_layers;
+  nn->buf[0] = buf0;
+  nn->buf[1] = buf1;
+  riotee_nn_start(nn);
+  return NN_ERR_OK;
+}
+
+void riotee_nn_start(riotee_nn_t *nn) {
+  nn->layer = 0;
+  nn->tile = 0;
+}
+
+static unsigned int n_tiles(const riotee_nn_layer_t *l) {
+  if (l->op == RIOTEE_NN_DENSE)
+    return (l->out.c + RIOTEE_NN_DENSE_TILE - 1) / RIOTEE_NN_DENSE_TILE;
+  return l->out.h;
+}
+
+static void run_tile(const riotee_nn_layer_t *l, const int8_t *in, int8_t *out, unsigned int tile) {
+  switch (l->op) {
+    case RIOTEE_NN_CONV2D:
+      riotee_nn_conv2d(l, in, out, tile, tile + 1);
+      break;
+    case RIOTEE_NN_DENSE: {
+      unsigned int end = (tile + 1) * RIOTEE_NN_DENSE_TILE;
+      riotee_nn_dense(l, in, out, tile * RIOTEE_NN_DENSE_TILE, (end > l->out.c) ? l->out.c : end);
+      break;
+    }
+    case RIOTEE_NN_MAXPOOL2D:
+      riotee_nn_maxpool2d(l, in, out, tile, tile + 1);
+      break;
+    case RIOTEE_NN_AVGPOOL2D:
+      riotee_nn_avgpool2d(l, in, out, tile, tile + 1);
+      break;
+  }
+}
+
+bool riotee_nn_step(riotee_nn_t *nn, unsigned int max_tiles) {
+  for (; (max_tiles > 0) && (nn->layer < nn->n_layers); max_tiles--) {
+    const riotee_nn_layer_t *l = &nn->layers[nn->layer];
+
+    /* A tile only writes its own outputs and never the input of the layer, so repeating it is harmless */
+    run_tile(l, nn->buf[nn->layer % 2], nn->buf[(nn->layer + 1) % 2], nn->tile);
+
+    if (++nn->tile == n_tiles(l)) {
+      nn->layer++;
+      nn->tile = 0;
+    }
+  }
+  return nn->layer == nn->n_layers;
+}
+
+unsigned int riotee_nn_argmax(const int8_t *x, unsigned int n) {
+  unsigned int best = 0;
+
+  for (unsigned int i = 1; i < n; i++) {
+    if (x[i] > x[best])
+      best = i;
+  }
+  return best;
+}
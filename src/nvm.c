@@ -90,6 +90,7 @@ static int prep_xfer(uint8_t* tx_buf, uint8_t* rx_buf, size_t n_tx, size_t n_rx)
   NRF_SPIM0->EVENTS_END = 0;
   NRF_SPIM0->EVENTS_STOPPED = 0;
   NRF_SPIM0->ENABLE = (SPIM_ENABLE_ENABLE_Enabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SPIM_NVM);
 
   return 0;
 }
@@ -135,6 +136,7 @@ int nvm_start(nvm_transfer_type_t transfer_type, uint32_t address) {
   }
 
   NRF_SPIM0->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SPIM_NVM);
   NRF_SPIM0->INTENSET = SPIM_INTENSET_END_Msk;
   /* See nRF52833 errata [78] */
   NRF_TIMER4->TASKS_SHUTDOWN = 1;
@@ -171,6 +173,7 @@ int nvm_write(uint8_t* src, size_t size) {
   while (NRF_SPIM0->EVENTS_STOPPED == 0) {
   }
   NRF_SPIM0->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SPIM_NVM);
 
   return 0;
 }
@@ -191,6 +194,7 @@ int nvm_read(uint8_t* dst, size_t size) {
   while (NRF_SPIM0->EVENTS_STOPPED == 0) {
   }
   NRF_SPIM0->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SPIM_NVM);
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <string.h>
+
+#include "nrf.h"
+#include "FreeRTOS.h"
+
+#include "printf.h"
+#include "riotee_probe.h"
+
+static riotee_probe_stats_t probes[RIOTEE_PROBE_N];
+
+static const char *names[RIOTEE_PROBE_N] = {
+    [RIOTEE_PROBE_CHECKPOINT_STORE] = "checkpoint_store",
+    [RIOTEE_PROBE_CHECKPOINT_LOAD] = "checkpoint_load",
+    [RIOTEE_PROBE_TEARDOWN] = "teardown",
+    [RIOTEE_PROBE_BLE_ADVERTISE] = "ble_advertise",
+    [RIOTEE_PROBE_STELLA_TRANSCEIVE] = "stella_transceive",
+    [RIOTEE_PROBE_ADC_SAMPLE] = "adc_sample",
+    [RIOTEE_PROBE_USER0] = "user0",
+    [RIOTEE_PROBE_USER1] = "user1",
+    [RIOTEE_PROBE_USER2] = "user2",
+    [RIOTEE_PROBE_USER3] = "user3",
+};
+
+void riotee_probe_reset(void) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  memset(probes, 0, sizeof(probes));
+  for (unsigned int i = 0; i < RIOTEE_PROBE_N; i++)
+    probes[i].cycles_min = UINT32_MAX;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void riotee_probe_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  riotee_probe_reset();
+}
+
+void riotee_probe_record(riotee_probe_id_t id, uint32_t cycles) {
+  if (id >= RIOTEE_PROBE_N)
+    return;
+
+  /* Works in task and interrupt context */
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  riotee_probe_stats_t *p = &probes[id];
+  p->n_calls++;
+  p->cycles_sum += cycles;
+  if (cycles < p->cycles_min)
+    p->cycles_min = cycles;
+  if (cycles > p->cycles_max)
+    p->cycles_max = cycles;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+int riotee_probe_get(riotee_probe_stats_t *dst, riotee_probe_id_t id) {
+  if (id >= RIOTEE_PROBE_N)
+    return -1;
+
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  memcpy(dst, &probes[id], sizeof(riotee_probe_stats_t));
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return 0;
+}
+
+int riotee_probe_set_name(riotee_probe_id_t id, const char *name) {
+  if ((id < RIOTEE_PROBE_USER0) || (id >= RIOTEE_PROBE_N))
+    return -1;
+  names[id] = name;
+  return 0;
+}
+
+void riotee_probe_dump(void) {
+  riotee_probe_stats_t p;
+
+  for (unsigned int i = 0; i < RIOTEE_PROBE_N; i++) {
+    riotee_probe_get(&p, i);
+    if (p.n_calls == 0)
+      continue;
+    printf("PROBE %s n=%u min=%u avg=%u max=%u\r\n", names[i], p.n_calls, p.cycles_min,
+           (unsigned int)(p.cycles_sum / p.n_calls), p.cycles_max);
+  }
+}
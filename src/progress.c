@@ -0,0 +1,249 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "riotee_nvm.h"
+#include "riotee_progress.h"
+
+/* Every slot has two records that are written alternately, so a torn write never destroys the last commit */
+typedef struct {
+  /* Address of the counter, identifies the owner of the slot */
+  uint32_t tag;
+  uint32_t seq;
+  uint32_t value;
+  uint32_t check;
+} record_t;
+
+#define RECORD_KEY 0x5EC0DED5
+
+/* This file is not excluded in linker.ld, so the table lives in retained memory and is part of every checkpoint */
+static riotee_progress_t *attached[RIOTEE_PROGRESS_N_SLOTS];
+/* Records of an earlier firmware are only trusted after the log was cleared */
+static bool log_cleared;
+
+static uint32_t record_check(const record_t *rec) {
+  return rec->tag ^ rec->seq ^ rec->value ^ RECORD_KEY;
+}
+
+static uint32_t record_addr(unsigned int slot, unsigned int copy) {
+  return RIOTEE_PROGRESS_NVM_ADDR + (2 * slot + copy) * sizeof(record_t);
+}
+
+/* Bound data is stored behind the records, one copy per record */
+static uint32_t data_addr(unsigned int slot, unsigned int copy) {
+  return RIOTEE_PROGRESS_NVM_ADDR + 2 * RIOTEE_PROGRESS_N_SLOTS * sizeof(record_t) +
+         (2 * slot + copy) * RIOTEE_PROGRESS_MAX_DATA;
+}
+
+/* Reads the latest valid record of a slot that belongs to tag. Returns -1 if there is none. */
+static int read_slot(unsigned int slot, uint32_t tag, record_t *dst) {
+  record_t recs[2];
+  int found = -1;
+
+  if (nvm_start(NVM_READ, record_addr(slot, 0)) != 0)
+    return -1;
+  int rc = nvm_read((uint8_t *)recs, sizeof(recs));
+  nvm_stop();
+  if (rc != 0)
+    return -1;
+
+  for (unsigned int i = 0; i < 2; i++) {
+    if ((recs[i].check != record_check(&recs[i])) || (recs[i].tag != tag))
+      continue;
+    if ((found != 0) || (recs[i].seq > dst->seq)) {
+      *dst = recs[i];
+      found = 0;
+    }
+  }
+  return found;
+}
+
+static int write_record(unsigned int slot, record_t *rec) {
+  int rc;
+
+  if (nvm_start(NVM_WRITE, record_addr(slot, rec->seq & 1)) != 0)
+    return -1;
+  rc = nvm_write((uint8_t *)rec, sizeof(record_t));
+  nvm_stop();
+  return rc;
+}
+
+/* Transfers the bound data of a counter from or to the copy that belongs to the record with sequence number seq */
+static int transfer_data(const riotee_progress_t *progress, uint32_t seq, nvm_transfer_type_t type) {
+  int rc;
+
+  if (progress->data == NULL)
+    return 0;
+  if (nvm_start(type, data_addr(progress->slot - 1, seq & 1)) != 0)
+    return -1;
+  if (type == NVM_WRITE)
+    rc = nvm_write((uint8_t *)progress->data, progress->size);
+  else
+    rc = nvm_read((uint8_t *)progress->data, progress->size);
+  nvm_stop();
+  return rc;
+}
+
+/* Overwrites all records, so that no commit of an earlier firmware is picked up */
+static int clear_log(void) {
+  record_t empty;
+  int rc = 0;
+
+  memset(&empty, 0, sizeof(empty));
+  if (nvm_start(NVM_WRITE, record_addr(0, 0)) != 0)
+    return -1;
+  for (unsigned int i = 0; (i < 2 * RIOTEE_PROGRESS_N_SLOTS) && (rc == 0); i++)
+    rc = nvm_write((uint8_t *)&empty, sizeof(empty));
+  nvm_stop();
+  if (rc == 0)
+    log_cleared = true;
+  return rc;
+}
+
+/* Must be called with the user task suspended or from within a critical section */
+static void sync_from_nvm(riotee_progress_t *progress) {
+  record_t rec = {0};
+
+  if (read_slot(progress->slot - 1, (uint32_t)(uintptr_t)progress, &rec) != 0)
+    return;
+  if ((rec.seq > progress->seq) && (transfer_data(progress, rec.seq, NVM_READ) == 0)) {
+    progress->value = rec.value;
+    progress->seq = rec.seq;
+  }
+}
+
+/* Discards changes to the bound data since the last commit, e.g. by work that resumed after a restore */
+static void reload_data(riotee_progress_t *progress) {
+  if ((progress->slot == 0) || (progress->seq == 0))
+    return;
+  taskENTER_CRITICAL();
+  transfer_data(progress, progress->seq, NVM_READ);
+  taskEXIT_CRITICAL();
+}
+
+int riotee_progress_bind(riotee_progress_t *progress, void *data, size_t size) {
+  if ((size > RIOTEE_PROGRESS_MAX_DATA) || ((data == NULL) && (size != 0)))
+    return PROGRESS_ERR_GENERIC;
+  progress->data = (size != 0) ? data : NULL;
+  progress->size = size;
+  return PROGRESS_ERR_OK;
+}
+
+/* The critical sections keep the runtime from taking a checkpoint while NVM and retained memory disagree. The NVM
+ * interrupts run above the syscall priority, so transfers proceed inside a critical section. */
+int riotee_progress_attach(riotee_progress_t *progress) {
+  if (progress->slot != 0)
+    return PROGRESS_ERR_OK;
+
+  int rc = PROGRESS_ERR_FULL;
+  taskENTER_CRITICAL();
+  /* Retry if clearing the log failed when the retained memory was initialized */
+  if (!log_cleared && (clear_log() != 0)) {
+    taskEXIT_CRITICAL();
+    return PROGRESS_ERR_GENERIC;
+  }
+  for (unsigned int i = 0; i < RIOTEE_PROGRESS_N_SLOTS; i++) {
+    if (attached[i] == NULL) {
+      attached[i] = progress;
+      progress->slot = i + 1;
+      sync_from_nvm(progress);
+      rc = PROGRESS_ERR_OK;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+  return rc;
+}
+
+int riotee_progress_commit(riotee_progress_t *progress, uint32_t value) {
+  int rc;
+
+  if ((rc = riotee_progress_attach(progress)) != PROGRESS_ERR_OK)
+    return rc;
+
+  record_t rec = {.tag = (uint32_t)(uintptr_t)progress, .seq = progress->seq + 1, .value = value};
+  rec.check = record_check(&rec);
+
+  taskENTER_CRITICAL();
+  /* The data goes to the copy of the new record, the previous record and its data stay intact until it is written */
+  if ((transfer_data(progress, rec.seq, NVM_WRITE) == 0) && (write_record(progress->slot - 1, &rec) == 0)) {
+    progress->value = value;
+    progress->seq = rec.seq;
+  } else {
+    rc = PROGRESS_ERR_GENERIC;
+  }
+  taskEXIT_CRITICAL();
+  return rc;
+}
+
+int riotee_progress_advance(riotee_progress_t *progress, uint32_t expected) {
+  /* A checkpoint was restored during the iteration and the counter already moved past it */
+  if (riotee_progress_get(progress) != expected) {
+    reload_data(progress);
+    return PROGRESS_ERR_OK;
+  }
+
+  int rc = riotee_progress_commit(progress, expected + 1);
+  /* Without a commit the iteration may run again after a reset, but the loop must not get stuck */
+  if (rc != PROGRESS_ERR_OK)
+    progress->value = expected + 1;
+  return rc;
+}
+
+int riotee_task_graph_run(riotee_progress_t *progress, const riotee_task_fn_t *tasks, uint32_t n_tasks, void *ctx,
+                          size_t ctx_size) {
+  int rc;
+
+  if (n_tasks > RIOTEE_TASK_MAX_TASKS)
+    return PROGRESS_ERR_GENERIC;
+  if ((rc = riotee_progress_bind(progress, ctx, ctx_size)) != PROGRESS_ERR_OK)
+    return rc;
+  if ((rc = riotee_progress_attach(progress)) != PROGRESS_ERR_OK)
+    return rc;
+
+  /* Upper half counts completed runs, lower half is the ID of the next task */
+  uint32_t run = riotee_progress_get(progress) >> 16;
+  for (;;) {
+    uint32_t state = riotee_progress_get(progress);
+    /* The restored checkpoint was taken during a run that has completed since */
+    if ((state >> 16) != run)
+      return PROGRESS_ERR_OK;
+
+    uint32_t id = state & 0xFFFF;
+    if (id >= n_tasks)
+      return PROGRESS_ERR_GENERIC;
+
+    uint32_t next = tasks[id](ctx);
+
+    /* A checkpoint was restored while the task ran and the counter was moved forward. The task resumed on the context
+     * of a later commit, its writes are discarded. */
+    if (riotee_progress_get(progress) != state) {
+      reload_data(progress);
+      continue;
+    }
+
+    if (next == RIOTEE_TASK_DONE)
+      return riotee_progress_commit(progress, (run + 1) << 16);
+    if (next >= n_tasks)
+      return PROGRESS_ERR_GENERIC;
+    if ((rc = riotee_progress_commit(progress, (run << 16) | next)) != PROGRESS_ERR_OK)
+      return rc;
+  }
+}
+
+/* Gets called by the runtime after a checkpoint was restored. Commits made after the checkpoint are only in NVM. */
+void sys_progress_restore(void) {
+  for (unsigned int i = 0; i < RIOTEE_PROGRESS_N_SLOTS; i++) {
+    if (attached[i] != NULL)
+      sync_from_nvm(attached[i]);
+  }
+}
+
+/* Gets called by the runtime when the retained memory is initialized. Commits of an earlier firmware are dropped. If
+ * the NVM is not ready, the next riotee_progress_attach() tries again. */
+int sys_progress_reset(void) {
+  log_cleared = false;
+  return clear_log();
+}
@@ -0,0 +1,121 @@
+#include <stdbool.h>
+
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "FreeRTOS.h"
+
+#include "riotee_pulse.h"
+
+#define PULSE_GPIOTE_CH 0
+#define PULSE_PPI_CH 8
+
+typedef struct {
+  uint32_t pin;
+  riotee_pulse_edge_t edge;
+  riotee_gpio_pin_pull_t pull;
+  bool active;
+  /* Value of riotee_pulse_count() when the last checkpoint was taken */
+  uint64_t count;
+} pulse_checkpoint_t;
+
+/* Part of every checkpoint */
+static pulse_checkpoint_t pulse_ckpt __attribute__((section(".retained_bss")));
+/* Count when the timer was last cleared */
+static uint64_t count_base;
+
+static void hw_start(void) {
+  nrf_gpio_cfg_input(pulse_ckpt.pin, (nrf_gpio_pin_pull_t)pulse_ckpt.pull);
+
+  NRF_GPIOTE->CONFIG[PULSE_GPIOTE_CH] = (GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos) |
+                                        ((pulse_ckpt.pin & 0x1F) << GPIOTE_CONFIG_PSEL_Pos) |
+                                        ((pulse_ckpt.pin >> 5) << GPIOTE_CONFIG_PORT_Pos) |
+                                        (pulse_ckpt.edge << GPIOTE_CONFIG_POLARITY_Pos);
+  NRF_GPIOTE->EVENTS_IN[PULSE_GPIOTE_CH] = 0;
+
+  NRF_TIMER3->MODE = TIMER_MODE_MODE_LowPowerCounter << TIMER_MODE_MODE_Pos;
+  NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_32Bit << TIMER_BITMODE_BITMODE_Pos;
+  NRF_TIMER3->TASKS_CLEAR = 1;
+  NRF_TIMER3->TASKS_START = 1;
+
+  NRF_PPI->CH[PULSE_PPI_CH].EEP = (uint32_t)&NRF_GPIOTE->EVENTS_IN[PULSE_GPIOTE_CH];
+  NRF_PPI->CH[PULSE_PPI_CH].TEP = (uint32_t)&NRF_TIMER3->TASKS_COUNT;
+  NRF_PPI->CHENSET = (1UL << PULSE_PPI_CH);
+}
+
+static void hw_stop(void) {
+  NRF_PPI->CHENCLR = (1UL << PULSE_PPI_CH);
+  NRF_GPIOTE->CONFIG[PULSE_GPIOTE_CH] = 0;
+  NRF_TIMER3->TASKS_STOP = 1;
+  /* See nRF52833 errata [78] */
+  NRF_TIMER3->TASKS_SHUTDOWN = 1;
+}
+
+/* Must be called with interrupts masked */
+static uint64_t count_locked(void) {
+  if (!pulse_ckpt.active)
+    return count_base;
+  NRF_TIMER3->TASKS_CAPTURE[0] = 1;
+  return count_base + NRF_TIMER3->CC[0];
+}
+
+int riotee_pulse_start(uint32_t pin, riotee_pulse_edge_t edge, riotee_gpio_pin_pull_t pull) {
+  if ((pin >= NUMBER_OF_PINS) || !nrf_gpio_pin_present_check(pin))
+    return PULSE_ERR_UNSUPPORTED;
+
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (pulse_ckpt.active) {
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return PULSE_ERR_BUSY;
+  }
+  pulse_ckpt.pin = pin;
+  pulse_ckpt.edge = edge;
+  pulse_ckpt.pull = pull;
+  pulse_ckpt.count = 0;
+  count_base = 0;
+  hw_start();
+  pulse_ckpt.active = true;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return PULSE_ERR_OK;
+}
+
+int riotee_pulse_stop(void) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (!pulse_ckpt.active) {
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return PULSE_ERR_GENERIC;
+  }
+  count_base = count_locked();
+  pulse_ckpt.count = count_base;
+  pulse_ckpt.active = false;
+  hw_stop();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return PULSE_ERR_OK;
+}
+
+uint64_t riotee_pulse_count(void) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint64_t count = count_locked();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return count;
+}
+
+void riotee_pulse_reset(void) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  count_base = 0;
+  pulse_ckpt.count = 0;
+  if (pulse_ckpt.active)
+    NRF_TIMER3->TASKS_CLEAR = 1;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/* Gets called by the runtime right before the retained memory is written to NVM */
+void sys_pulse_checkpoint(void) {
+  pulse_ckpt.count = riotee_pulse_count();
+}
+
+/* Gets called by the runtime after a checkpoint was restored. The timer was reset together with the CPU. */
+void sys_pulse_restore(void) {
+  count_base = pulse_ckpt.count;
+  if (pulse_ckpt.active)
+    hw_start();
+}
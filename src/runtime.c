@@ -13,6 +13,7 @@
 #include "riotee_nvm.h"
 #include "runtime.h"
 #include "riotee_thresholds.h"
+#include "riotee_probe.h"
 
 #define SYS_STACK_SIZE (configMINIMAL_STACK_SIZE + 128)
 
@@ -46,9 +47,73 @@ TaskHandle_t usr_task_handle;
 
 /* Runtime stats go into retained bss so they are automatically checkpointed. */
 runtime_stats_t runtime_stats __attribute__((section(".retained_bss")));
+runtime_acct_t runtime_acct __attribute__((section(".retained_bss")));
+
+/* Active current per domain in uA. Rough figures from the nRF52833 product specification at 3V with DC/DC converter
+ * disabled. Override with runtime_acct_set_current() for a more accurate model of your board. */
+static unsigned int acct_current_ua[ACCT_N] = {
+    [ACCT_RADIO_TX] = 9600,
+    [ACCT_RADIO_RX] = 6700,
+    [ACCT_HFXO_BLE] = 250,
+    [ACCT_HFXO_STELLA] = 250,
+    [ACCT_SAADC] = 1000,
+    [ACCT_TWIM] = 400,
+    [ACCT_SPIM_SPIC] = 500,
+    [ACCT_SPIM_NVM] = 500,
+};
+/* RTC counter value at the start of the current active period of every domain */
+static uint32_t acct_start_ticks[ACCT_N];
+static uint32_t acct_active_mask;
 
 void sys_setup_timer(unsigned int ticks);
 void sys_cancel_timer(void);
+void sys_time_checkpoint(void);
+void sys_time_restore(void);
+void sys_pulse_checkpoint(void);
+void sys_pulse_restore(void);
+void sys_progress_restore(void);
+int sys_progress_reset(void);
+
+void acct_start(acct_domain_t domain) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if ((acct_active_mask & (1UL << domain)) == 0) {
+    acct_active_mask |= (1UL << domain);
+    acct_start_ticks[domain] = NRF_RTC0->COUNTER;
+    runtime_acct.n_active[domain]++;
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void acct_stop(acct_domain_t domain) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (acct_active_mask & (1UL << domain)) {
+    acct_active_mask &= ~(1UL << domain);
+    uint32_t ticks = (NRF_RTC0->COUNTER - acct_start_ticks[domain]) % (1 << 24);
+    /* 32768Hz ticks to us. The RTC quantizes every period, but the error averages out over many periods. */
+    runtime_acct.active_us[domain] += ((uint64_t)ticks * 15625) >> 9;
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void acct_add_us(acct_domain_t domain, unsigned int us) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  runtime_acct.active_us[domain] += us;
+  runtime_acct.n_active[domain]++;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+int runtime_acct_set_current(acct_domain_t domain, unsigned int current_ua) {
+  if (domain >= ACCT_N)
+    return -1;
+  acct_current_ua[domain] = current_ua;
+  return 0;
+}
+
+uint64_t runtime_acct_charge_nc(acct_domain_t domain) {
+  if (domain >= ACCT_N)
+    return 0;
+  return runtime_acct.active_us[domain] * acct_current_ua[domain] / 1000;
+}
 
 /* Dummy callback to be called when low capacitor voltage is detected. Can be overwritten by the user. */
 __attribute__((weak)) void turnoff_callback(void){};
@@ -92,6 +157,7 @@ enum { NVM_SIG_VALID = 0x0D15EA5E, NVM_SIG_INVALID = 0x8BADF00D };
 /* Stores task stack and static/global variables in non-volatile memory. */
 static int checkpoint_store() {
   checkpoint_header hdr;
+  RIOTEE_PROBE_START(RIOTEE_PROBE_CHECKPOINT_STORE);
 
   hdr.top_of_stack = *(uint32_t *)&usr_task_tcb;
 
@@ -105,6 +171,13 @@ static int checkpoint_store() {
    * loaded. */
   hdr.signature = NVM_SIG_INVALID;
 
+  /* Update stats and time before the retained sections are written so that they are part of the snapshot */
+  sys_time_checkpoint();
+  sys_pulse_checkpoint();
+  runtime_stats.n_checkpoint++;
+  runtime_stats.checkpoint_bytes +=
+      sizeof(checkpoint_header) + hdr.stack_size * sizeof(StackType_t) + hdr.data_size + hdr.bss_size;
+
   nvm_start(NVM_WRITE, 0x0);
   nvm_write((uint8_t *)&hdr, sizeof(checkpoint_header));
   nvm_write((uint8_t *)hdr.top_of_stack, hdr.stack_size * sizeof(StackType_t));
@@ -124,12 +197,14 @@ static int checkpoint_store() {
     overwrite_marker();
   }
 
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_CHECKPOINT_STORE);
   return 0;
 }
 
 /* Loads a snapshot from NVM into task stack and static/global variables. */
 static int checkpoint_load() {
   checkpoint_header hdr;
+  RIOTEE_PROBE_START(RIOTEE_PROBE_CHECKPOINT_LOAD);
 
   nvm_start(NVM_READ, 0x0);
   nvm_read((uint8_t *)&hdr, sizeof(checkpoint_header));
@@ -149,18 +224,113 @@ static int checkpoint_load() {
 
   /* Copy top of stack into freertos TCB structure */
   memcpy(&usr_task_tcb, &hdr.top_of_stack, sizeof(uint32_t));
+
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_CHECKPOINT_LOAD);
   return 0;
 }
 
-/* We are not using any timer for scheduling */
+/* The RTC counts at the tick rate, i.e. one RTC increment is one FreeRTOS tick */
+#define TICK_RTC_PRESCALER ((32768 / configTICK_RATE_HZ) - 1)
+#define TICK_RTC_MASK ((1UL << 24) - 1)
+/* Leaves plenty of margin to the 24-bit range of the RTC */
+#define TICK_MAX_SUPPRESSED (1UL << 22)
+/* RTC compare register must be set at least two increments into the future */
+#define TICK_MIN_SUPPRESSED 2
+
+/* RTC counter value up to which ticks have been passed to the kernel */
+static uint32_t tick_last_count;
+/* Set when vPortSuppressTicksAndSleep() slept, so that the idle hook does not sleep again right away */
+static bool tickless_slept;
+
+/* The tick is generated by RTC1. SysTick would stop while the CPU sleeps. */
 void vPortSetupTimerInterrupt(void) {
-  return;
+  NRF_RTC1->PRESCALER = TICK_RTC_PRESCALER;
+  /* EVTEN stays cleared, so the TICK event stops while its interrupt is disabled during tickless sleep */
+  NRF_RTC1->INTENSET = RTC_INTENSET_TICK_Msk;
+
+  NVIC_SetPriority(RTC1_IRQn, configKERNEL_INTERRUPT_PRIORITY >> (8 - configPRIO_BITS));
+  NVIC_EnableIRQ(RTC1_IRQn);
+
+  NRF_RTC1->TASKS_CLEAR = 1;
+  NRF_RTC1->TASKS_START = 1;
+  tick_last_count = 0;
 }
 
-/* This keeps the MCU in low power mode */
+void RTC1_IRQHandler(void) {
+  BaseType_t xSwitchRequired = pdFALSE;
+
+  NRF_RTC1->EVENTS_TICK = 0;
+  NRF_RTC1->EVENTS_COMPARE[0] = 0;
+
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  /* Usually only the current tick. More if the interrupt was held off, ticks slept through in tickless idle were
+   * already stepped by vPortSuppressTicksAndSleep(). */
+  uint32_t now = NRF_RTC1->COUNTER;
+  uint32_t n_ticks = (now - tick_last_count) & TICK_RTC_MASK;
+  tick_last_count = now;
+  while (n_ticks--) {
+    if (xTaskIncrementTick() != pdFALSE)
+      xSwitchRequired = pdTRUE;
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  portYIELD_FROM_ISR(xSwitchRequired);
+}
+
+/* Gets called by the idle task with the scheduler suspended when no task is ready for at least xExpectedIdleTime */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+  if (xExpectedIdleTime > TICK_MAX_SUPPRESSED)
+    xExpectedIdleTime = TICK_MAX_SUPPRESSED;
+
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  uint32_t wakeup = (tick_last_count + xExpectedIdleTime) & TICK_RTC_MASK;
+  uint32_t remaining = (wakeup - NRF_RTC1->COUNTER) & TICK_RTC_MASK;
+
+  /* A tick interrupt is pending or a task became ready in the meantime */
+  if ((remaining < TICK_MIN_SUPPRESSED) || (remaining > xExpectedIdleTime) ||
+      (eTaskConfirmSleepModeStatus() == eAbortSleep)) {
+    __enable_irq();
+    return;
+  }
+
+  /* Replace the periodic tick by a single compare event at the expected wakeup time */
+  NRF_RTC1->INTENCLR = RTC_INTENCLR_TICK_Msk;
+  NRF_RTC1->CC[0] = wakeup;
+  NRF_RTC1->EVENTS_COMPARE[0] = 0;
+  NRF_RTC1->INTENSET = RTC_INTENSET_COMPARE0_Msk;
+
+  /* Wakes up on any pending interrupt, even though interrupts are masked */
+  __DSB();
+  __WFI();
+
+  NRF_RTC1->INTENCLR = RTC_INTENCLR_COMPARE0_Msk;
+
+  /* Steps the kernel over the ticks slept through in one go. The last tick is left to the interrupt, which is pending
+   * if the compare event fired or comes with the next TICK event after an early wakeup. */
+  uint32_t n_slept = (NRF_RTC1->COUNTER - tick_last_count) & TICK_RTC_MASK;
+  if (n_slept > xExpectedIdleTime)
+    n_slept = xExpectedIdleTime;
+  if (n_slept > 1) {
+    vTaskStepTick(n_slept - 1);
+    tick_last_count = (tick_last_count + n_slept - 1) & TICK_RTC_MASK;
+  }
+  tickless_slept = true;
+
+  NRF_RTC1->INTENSET = RTC_INTENSET_TICK_Msk;
+  __enable_irq();
+}
+
+/* Sleeps until the next interrupt if the idle task did not go through vPortSuppressTicksAndSleep() in the last round,
+ * e.g. because the next task is due within a few ticks or sleep was aborted */
 void vApplicationIdleHook(void) {
-  enter_low_power();
-  return;
+  if (!tickless_slept) {
+    __DSB();
+    __WFI();
+  }
+  tickless_slept = false;
 }
 
 /* Assigns statically allocated memory for FreeRTOS idle task */
@@ -200,6 +370,9 @@ static void initialize_retained(void) {
   src = &__bss_retained_start__;
   while (src < &__bss_retained_end__)
     *(src++) = 0;
+
+  /* Progress counters start over together with the retained memory */
+  sys_progress_reset();
 }
 
 /* Waits until capacitor is fully charged as indicated by PWRGD_H pin */
@@ -211,6 +384,8 @@ static void teardown(void) {
   /* Call all registered teardown functions */
   void (*fn_teardown)(void);
   uint32_t *fn_addr;
+  RIOTEE_PROBE_START(RIOTEE_PROBE_TEARDOWN);
+
   for (fn_addr = &__teardown_start__; fn_addr < &__teardown_end__; fn_addr++) {
     fn_teardown = (void (*)(void)) * fn_addr;
     if (fn_teardown != NULL)
@@ -219,6 +394,8 @@ static void teardown(void) {
 
   /* Give the application an opportunity to switch off power-hungry devices */
   turnoff_callback();
+
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_TEARDOWN);
 }
 
 /* High priority system task initializes runtime, and handles intermittent execution and checkpointing. */
@@ -239,6 +416,9 @@ static void sys_task(void *pvParameter) {
 
   } else {
     if (checkpoint_load() == 0) {
+      sys_time_restore();
+      sys_pulse_restore();
+      sys_progress_restore();
       /* Unblock the user task */
       xTaskNotifyIndexed(usr_task_handle, 1, EVT_RESET, eSetValueWithOverwrite);
       runtime_stats.n_reset++;
@@ -306,6 +486,10 @@ static void sys_task(void *pvParameter) {
 void runtime_start(void) {
   riotee_uart_init(PIN_D1, 250000UL);
 
+#if RIOTEE_PROBES
+  riotee_probe_init();
+#endif
+
   riotee_gpint_init();
   riotee_timing_init();
 
@@ -47,6 +47,7 @@ static void teardown() {
   while (NRF_SPIM3->EVENTS_STOPPED == 0) {
   }
   NRF_SPIM3->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SPIM_SPIC);
   xTaskNotifyIndexed(usr_task_handle, 1, EVT_TEARDOWN, eSetValueWithOverwrite);
   spic_teardown_ptr = NULL;
 }
@@ -68,6 +69,7 @@ int spic_transfer(uint8_t* data_tx, size_t n_tx, uint8_t* data_rx, size_t n_rx)
   printf_("SPI Data in Driver: %x, %x, %x, %x \n", data_tx[0], data_tx[1], data_tx[2], data_tx[3]);
   taskENTER_CRITICAL();
   NRF_SPIM3->ENABLE = (SPIM_ENABLE_ENABLE_Enabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_start(ACCT_SPIM_SPIC);
 
   NRF_SPIM3->TXD.PTR = (uint32_t)data_tx;
   NRF_SPIM3->TXD.MAXCNT = n_tx;
@@ -92,6 +94,7 @@ int spic_transfer(uint8_t* data_tx, size_t n_tx, uint8_t* data_rx, size_t n_rx)
   while (NRF_SPIM3->EVENTS_STOPPED == 0) {
   }
   NRF_SPIM3->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
+  acct_stop(ACCT_SPIM_SPIC);
 
   return 0;
 }
@@ -7,6 +7,7 @@
 #include "radio.h"
 #include "runtime.h"
 #include "printf.h"
+#include "riotee_probe.h"
 
 static riotee_stella_pkt_t rx_buf;
 static riotee_stella_pkt_t tx_buf;
@@ -34,11 +35,18 @@ static uint32_t _dev_id;
 
 TEARDOWN_FUN(teardown_ptr);
 
+/* Switches off radio and HFXO at the end of a transaction */
+static inline void transaction_stop(void) {
+  radio_stop();
+  acct_stop(ACCT_RADIO_RX);
+  acct_stop(ACCT_HFXO_STELLA);
+}
+
 /* Valid acknowledgement received */
 static void radio_crc_ok(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-  radio_stop();
+  transaction_stop();
   teardown_ptr = NULL;
   xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_STELLA_RCVD, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
 
@@ -48,7 +56,7 @@ static void radio_crc_ok(void) {
 static void radio_crc_err(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-  radio_stop();
+  transaction_stop();
   teardown_ptr = NULL;
   xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_STELLA_CRCERR, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
 
@@ -62,12 +70,15 @@ static void radio_address(void) {
 }
 
 static void radio_txready(void) {
+  /* Ramp-up, preamble, address, length field, packet and CRC */
+  acct_add_us(ACCT_RADIO_TX, 40 + (1 + 3 + 1 + ((riotee_stella_pkt_t *)NRF_RADIO->PACKETPTR)->len + 3) * 8);
   /* Now that radio is transmitting, point the double-buffered packet pointer to the rx buffer*/
   NRF_RADIO->PACKETPTR = (uint32_t)rx_buf_ptr;
 }
 
 /* Radio has ramped up for reception of an acknowledgement */
 static void radio_rxready(void) {
+  acct_start(ACCT_RADIO_RX);
   NRF_RADIO->SHORTS &= ~(RADIO_SHORTS_DISABLED_RXEN_Msk);
 
   /* Notify us when an address is received */
@@ -81,8 +92,8 @@ static void radio_rxready(void) {
 static int timer_init(void) {
   /* 1us period */
   NRF_TIMER2->PRESCALER = 4;
-  /* 100us timeout for receiving the address of the acknowledgement */
-  NRF_TIMER2->CC[0] = 100;
+  /* Timeout for receiving the address of the acknowledgement */
+  NRF_TIMER2->CC[0] = STELLA_ACK_TIMEOUT_US;
   NRF_TIMER2->INTENSET |= TIMER_INTENSET_COMPARE0_Msk;
   NRF_TIMER2->SHORTS |= TIMER_SHORTS_COMPARE0_STOP_Msk;
   NVIC_EnableIRQ(TIMER2_IRQn);
@@ -149,7 +160,7 @@ void TIMER2_IRQHandler(void) {
   if (NRF_TIMER2->EVENTS_COMPARE[0] == 1) {
     NRF_TIMER2->EVENTS_COMPARE[0] = 0;
     radio_cb_unregister(RADIO_EVT_ADDRESS);
-    radio_stop();
+    transaction_stop();
     teardown_ptr = NULL;
 
     xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_STELLA_TIMEOUT, eSetBits, &xHigherPriorityTaskWoken);
@@ -158,7 +169,7 @@ void TIMER2_IRQHandler(void) {
 }
 
 static void teardown(void) {
-  radio_stop();
+  transaction_stop();
   radio_cb_unregister(RADIO_EVT_ADDRESS);
   NRF_TIMER2->TASKS_STOP = 1;
   xTaskNotifyIndexed(usr_task_handle, 1, EVT_TEARDOWN, eSetValueWithOverwrite);
@@ -167,10 +178,12 @@ static void teardown(void) {
 
 int riotee_stella_transceive(riotee_stella_pkt_t *rx_pkt, riotee_stella_pkt_t *tx_pkt) {
   unsigned long notification_value;
+  RIOTEE_PROBE_START(RIOTEE_PROBE_STELLA_TRANSCEIVE);
 
   taskENTER_CRITICAL();
   /* Packet transmission will start automatically when HFXO is running */
   NRF_CLOCK->TASKS_HFCLKSTART = 1;
+  acct_start(ACCT_HFXO_STELLA);
 
   /* Set correct device ID */
   tx_pkt->hdr.dev_id = _dev_id;
@@ -185,6 +198,7 @@ int riotee_stella_transceive(riotee_stella_pkt_t *rx_pkt, riotee_stella_pkt_t *t
 
   /* Wait until acknowledgement is received/expired */
   xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+  RIOTEE_PROBE_STOP(RIOTEE_PROBE_STELLA_TRANSCEIVE);
 
   if (notification_value == EVT_RESET)
     return STELLA_ERR_RESET;
@@ -195,22 +209,15 @@ int riotee_stella_transceive(riotee_stella_pkt_t *rx_pkt, riotee_stella_pkt_t *t
   if (notification_value == EVT_STELLA_TIMEOUT)
     return STELLA_ERR_NOACK;
 
-  /* Acknowledgement ID must match packet ID */
-  if (rx_pkt->hdr.ack_id != tx_pkt->hdr.pkt_id)
-    return STELLA_ERR_GENERIC;
-
-  /* Acknowledgement always contains device's ID */
-  if (rx_pkt->hdr.dev_id != tx_pkt->hdr.dev_id)
-    return STELLA_ERR_GENERIC;
-
-  return STELLA_ERR_OK;
+  return riotee_stella_check_ack(rx_pkt, tx_pkt);
 }
 
 int riotee_stella_send(uint8_t *data, size_t n) {
-  memcpy(tx_buf.data, data, n);
-
-  tx_buf.len = sizeof(riotee_stella_pkt_header_t) + n;
-  tx_buf.hdr.pkt_id = pkt_counter++;
+  int rc;
+  /* The counter only advances for packets that are actually sent, so the basestation sees no gaps */
+  if ((rc = riotee_stella_pkt_build(&tx_buf, _dev_id, pkt_counter, 0, data, n)) != STELLA_ERR_OK)
+    return rc;
+  pkt_counter++;
   return riotee_stella_transceive(&rx_buf, &tx_buf);
 }
 
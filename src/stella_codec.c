@@ -0,0 +1,94 @@
+#include <string.h>
+
+#include "riotee_stella_codec.h"
+
+static inline void put_le16(uint8_t *dst, uint16_t val) {
+  dst[0] = val & 0xFF;
+  dst[1] = val >> 8;
+}
+
+static inline void put_le32(uint8_t *dst, uint32_t val) {
+  put_le16(dst, val & 0xFFFF);
+  put_le16(dst + 2, val >> 16);
+}
+
+static inline uint16_t get_le16(const uint8_t *src) {
+  return src[0] | (src[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t *src) {
+  return get_le16(src) | ((uint32_t)get_le16(src + 2) << 16);
+}
+
+int riotee_stella_pkt_build(riotee_stella_pkt_t *pkt, uint32_t dev_id, uint16_t pkt_id, uint16_t ack_id,
+                            const uint8_t *data, size_t n) {
+  if (n > STELLA_MAX_PAYLOAD)
+    return STELLA_ERR_GENERIC;
+
+  pkt->len = sizeof(riotee_stella_pkt_header_t) + n;
+  pkt->hdr.dev_id = dev_id;
+  pkt->hdr.pkt_id = pkt_id;
+  pkt->hdr.ack_id = ack_id;
+  if (n > 0)
+    memcpy(pkt->data, data, n);
+  return STELLA_ERR_OK;
+}
+
+int riotee_stella_pkt_payload_len(const riotee_stella_pkt_t *pkt) {
+  /* Every packet carries at least the header */
+  if (pkt->len < sizeof(riotee_stella_pkt_header_t))
+    return STELLA_ERR_GENERIC;
+  return pkt->len - sizeof(riotee_stella_pkt_header_t);
+}
+
+int riotee_stella_encode(uint8_t *dst, size_t size, const riotee_stella_pkt_t *pkt) {
+  int n_payload;
+
+  if ((n_payload = riotee_stella_pkt_payload_len(pkt)) < 0)
+    return n_payload;
+  if (size < (size_t)pkt->len + 1)
+    return STELLA_ERR_GENERIC;
+
+  dst[0] = pkt->len;
+  put_le32(&dst[1], pkt->hdr.dev_id);
+  put_le16(&dst[5], pkt->hdr.pkt_id);
+  put_le16(&dst[7], pkt->hdr.ack_id);
+  memcpy(&dst[9], pkt->data, n_payload);
+
+  return pkt->len + 1;
+}
+
+int riotee_stella_decode(riotee_stella_pkt_t *pkt, const uint8_t *src, size_t n) {
+  /* Length field must match the number of received bytes */
+  if ((n < 1 + sizeof(riotee_stella_pkt_header_t)) || (src[0] != n - 1))
+    return STELLA_ERR_GENERIC;
+
+  pkt->len = src[0];
+  pkt->hdr.dev_id = get_le32(&src[1]);
+  pkt->hdr.pkt_id = get_le16(&src[5]);
+  pkt->hdr.ack_id = get_le16(&src[7]);
+  memcpy(pkt->data, &src[9], n - 9);
+
+  return STELLA_ERR_OK;
+}
+
+int riotee_stella_build_ack(riotee_stella_pkt_t *ack, const riotee_stella_pkt_t *ul, uint16_t pkt_id,
+                            const uint8_t *data, size_t n) {
+  /* Acknowledgement echoes the device ID and carries the ID of the acknowledged packet */
+  return riotee_stella_pkt_build(ack, ul->hdr.dev_id, pkt_id, ul->hdr.pkt_id, data, n);
+}
+
+int riotee_stella_check_ack(const riotee_stella_pkt_t *ack, const riotee_stella_pkt_t *ul) {
+  if (riotee_stella_pkt_payload_len(ack) < 0)
+    return STELLA_ERR_GENERIC;
+
+  /* Acknowledgement ID must match packet ID */
+  if (ack->hdr.ack_id != ul->hdr.pkt_id)
+    return STELLA_ERR_GENERIC;
+
+  /* Acknowledgement always contains device's ID */
+  if (ack->hdr.dev_id != ul->hdr.dev_id)
+    return STELLA_ERR_GENERIC;
+
+  return STELLA_ERR_OK;
+}
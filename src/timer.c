@@ -0,0 +1,195 @@
+#include "nrf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "riotee_timer.h"
+
+#define RTC_MASK ((1UL << 24) - 1)
+/* Compare register must be set at least two increments into the future */
+#define RTC_MIN_DELTA 2
+/* Deadlines further away are reached with intermediate compare events */
+#define RTC_MAX_DELTA (1UL << 23)
+
+/* Active timers sorted by deadline */
+static riotee_timer_t *head;
+/* Number of RTC overflows since the RTC was started */
+static uint32_t n_overflow;
+
+/* Must be called with interrupts masked */
+static uint64_t now_locked(void) {
+  uint32_t counter = NRF_RTC0->COUNTER;
+  uint32_t overflows = n_overflow;
+  /* Overflow that was not yet handled by the interrupt */
+  if (NRF_RTC0->EVENTS_OVRFLW == 1) {
+    overflows++;
+    counter = NRF_RTC0->COUNTER;
+  }
+  return ((uint64_t)overflows << 24) | counter;
+}
+
+uint64_t riotee_timer_now(void) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint64_t now = now_locked();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return now;
+}
+
+/* Removes timer from the list. Returns true if it was active. Must be called with interrupts masked. */
+static bool list_remove(riotee_timer_t *timer) {
+  for (riotee_timer_t **pp = &head; *pp != NULL; pp = &(*pp)->next) {
+    if (*pp == timer) {
+      *pp = timer->next;
+      timer->next = NULL;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Inserts timer behind all timers with the same or earlier deadline. Must be called with interrupts masked. */
+static void list_insert(riotee_timer_t *timer) {
+  riotee_timer_t **pp = &head;
+  while ((*pp != NULL) && ((*pp)->deadline <= timer->deadline))
+    pp = &(*pp)->next;
+  timer->next = *pp;
+  *pp = timer;
+}
+
+/* Sets the compare register to the earliest deadline. Must be called with interrupts masked. */
+static void schedule(void) {
+  if (head == NULL) {
+    NRF_RTC0->INTENCLR = RTC_INTENCLR_COMPARE3_Msk;
+    return;
+  }
+
+  uint64_t now = now_locked();
+  if (head->deadline < now + RTC_MIN_DELTA) {
+    /* Too close to set the compare register, let the interrupt handler take care */
+    NVIC_SetPendingIRQ(RTC0_IRQn);
+    return;
+  }
+
+  uint64_t delta = head->deadline - now;
+  if (delta > RTC_MAX_DELTA)
+    delta = RTC_MAX_DELTA;
+
+  NRF_RTC0->CC[3] = (now + delta) & RTC_MASK;
+  NRF_RTC0->EVENTS_COMPARE[3] = 0;
+  NRF_RTC0->INTENSET = RTC_INTENSET_COMPARE3_Msk;
+}
+
+void RTC0_IRQHandler(void) {
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  riotee_timer_t *timer;
+
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (NRF_RTC0->EVENTS_OVRFLW == 1) {
+    NRF_RTC0->EVENTS_OVRFLW = 0;
+    n_overflow++;
+  }
+  NRF_RTC0->EVENTS_COMPARE[3] = 0;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+  for (;;) {
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint64_t now = now_locked();
+    if ((head == NULL) || (head->deadline > now)) {
+      schedule();
+      portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+      break;
+    }
+
+    timer = head;
+    head = timer->next;
+    timer->next = NULL;
+    if (timer->period > 0) {
+      /* Keep the period without drift, but don't fire repeatedly to catch up with missed periods */
+      timer->deadline += timer->period;
+      if (timer->deadline <= now)
+        timer->deadline = now + timer->period;
+      list_insert(timer);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    /* Callback may start or stop timers, including this one */
+    if (timer->cb != NULL)
+      timer->cb(timer);
+    else if (timer->task != NULL)
+      xTaskNotifyIndexedFromISR(timer->task, 1, timer->notify_value, eSetValueWithOverwrite,
+                                &xHigherPriorityTaskWoken);
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void riotee_timer_init_cb(riotee_timer_t *timer, riotee_timer_cb_t cb, void *ctx) {
+  timer->next = NULL;
+  timer->cb = cb;
+  timer->ctx = ctx;
+  timer->task = NULL;
+}
+
+void riotee_timer_init_notify(riotee_timer_t *timer, TaskHandle_t task, uint32_t notify_value) {
+  timer->next = NULL;
+  timer->cb = NULL;
+  timer->ctx = NULL;
+  timer->task = task;
+  timer->notify_value = notify_value;
+}
+
+int riotee_timer_start_at(riotee_timer_t *timer, uint64_t deadline, uint32_t period) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  list_remove(timer);
+  timer->deadline = deadline;
+  timer->period = period;
+  list_insert(timer);
+  if (head == timer)
+    schedule();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return TIMER_ERR_OK;
+}
+
+int riotee_timer_start(riotee_timer_t *timer, uint32_t ticks, uint32_t period) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  int rc = riotee_timer_start_at(timer, now_locked() + ticks, period);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return rc;
+}
+
+int riotee_timer_stop(riotee_timer_t *timer) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  bool was_head = (head == timer);
+  list_remove(timer);
+  if (was_head)
+    schedule();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return TIMER_ERR_OK;
+}
+
+bool riotee_timer_is_active(riotee_timer_t *timer) {
+  bool active = false;
+
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  for (riotee_timer_t *t = head; t != NULL; t = t->next) {
+    if (t == timer) {
+      active = true;
+      break;
+    }
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return active;
+}
+
+/* Expects RTC0 to be configured and started by riotee_timing_init() */
+int riotee_timer_init(void) {
+  head = NULL;
+  n_overflow = 0;
+
+  NRF_RTC0->EVENTS_OVRFLW = 0;
+  NRF_RTC0->INTENSET = RTC_INTENSET_OVRFLW_Msk;
+
+  /* Interrupt handler uses FreeRTOS API */
+  NVIC_SetPriority(RTC0_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8 - configPRIO_BITS));
+  NVIC_EnableIRQ(RTC0_IRQn);
+  return TIMER_ERR_OK;
+}
@@ -2,59 +2,126 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "runtime.h"
+#include "riotee_timer.h"
+#include "riotee_timing.h"
+#include "riotee_am1805.h"
 
 #include <soc/nrfx_coredep.h>
 
-void riotee_delay_us(unsigned int us) {
-  nrfx_coredep_delay_us(us);
-}
+/* Shorter delays are spun, sleeping does not pay off */
+#define DELAY_SLEEP_MIN_US 20
+/* CPU wakes up this long before the end of the delay and spins for the rest to compensate for wakeup latency */
+#define DELAY_WAKEUP_US 4
 
-void riotee_delay_ms(unsigned int ms) {
-  if (ms == 0) {
-    return;
-  }
+/* TIMER1 is used by one delay at a time. Concurrent delays, e.g. from an interrupt, spin. */
+static volatile bool delay_timer_busy;
 
-  do {
-    nrfx_coredep_delay_us(1000);
-  } while (--ms);
-}
+/* Set by the teardown function when it stopped TIMER1 during a delay. Retained together with the remaining time, so
+ * that the delay continues after the user task was resumed or a checkpoint was restored. */
+static volatile bool delay_interrupted __attribute__((section(".retained_bss")));
+static unsigned int delay_remaining_us __attribute__((section(".retained_bss")));
 
-void RTC0_IRQHandler(void) {
-  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+TEARDOWN_FUN(delay_teardown_ptr);
 
-  if ((NRF_RTC0->INTENSET & RTC_INTENSET_COMPARE0_Msk) && (NRF_RTC0->EVENTS_COMPARE[0] == 1)) {
-    NRF_RTC0->EVENTS_COMPARE[0] = 0;
-    NRF_RTC0->EVTENCLR = RTC_EVTENCLR_COMPARE0_Msk;
-    NRF_RTC0->INTENCLR = RTC_INTENCLR_COMPARE0_Msk;
+static bool delay_timer_acquire(void) {
+  bool acquired = false;
 
-    xTaskNotifyIndexedFromISR(usr_task_handle, 1, EVT_RTC, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (!delay_timer_busy) {
+    delay_timer_busy = true;
+    acquired = true;
   }
-  if ((NRF_RTC0->INTENSET & RTC_INTENSET_COMPARE1_Msk) && (NRF_RTC0->EVENTS_COMPARE[1] == 1)) {
-    NRF_RTC0->EVENTS_COMPARE[1] = 0;
-    NRF_RTC0->EVTENCLR = RTC_EVTENCLR_COMPARE1_Msk;
-    NRF_RTC0->INTENCLR = RTC_INTENCLR_COMPARE1_Msk;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  return acquired;
+}
+
+static void delay_timer_release(void) {
+  delay_teardown_ptr = NULL;
+  NRF_TIMER1->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk;
+  NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+  NRF_TIMER1->EVENTS_COMPARE[1] = 0;
+  NVIC_ClearPendingIRQ(TIMER1_IRQn);
+  /* See nRF52833 errata [78] */
+  NRF_TIMER1->TASKS_SHUTDOWN = 1;
+  delay_timer_busy = false;
+}
+
+/* Stops TIMER1 and records how much of the delay is left. The timer compare events can no longer fire afterwards. */
+static void delay_teardown(void) {
+  NRF_TIMER1->TASKS_CAPTURE[2] = 1;
+  uint32_t elapsed = NRF_TIMER1->CC[2];
+  delay_remaining_us = (elapsed < NRF_TIMER1->CC[1]) ? NRF_TIMER1->CC[1] - elapsed : 0;
+  delay_timer_release();
+  delay_interrupted = true;
+}
 
-    xTaskNotifyIndexedFromISR(sys_task_handle, 1, EVT_RTC, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+/* Sleeps in WFE until TIMER1 expires. Does not rely on interrupts, so this also works inside critical sections. If the
+ * user task is suspended for a teardown, the delay continues with the remaining time afterwards. */
+void riotee_delay_us(unsigned int us) {
+  while ((us >= DELAY_SLEEP_MIN_US) && delay_timer_acquire()) {
+    delay_interrupted = false;
+
+    NRF_TIMER1->CC[0] = us - DELAY_WAKEUP_US;
+    NRF_TIMER1->CC[1] = us;
+    NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+    NRF_TIMER1->EVENTS_COMPARE[1] = 0;
+    /* Interrupt stays disabled in the NVIC, it only becomes pending to wake up the CPU */
+    NRF_TIMER1->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+
+    uint32_t sevonpend = SCB->SCR & SCB_SCR_SEVONPEND_Msk;
+    SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+
+    NRF_TIMER1->TASKS_CLEAR = 1;
+    /* Registered before the timer starts, so that a teardown always finds a running timer stopped */
+    delay_teardown_ptr = delay_teardown;
+    NRF_TIMER1->TASKS_START = 1;
+
+    /* Resuming the task after a teardown is an exception return, which wakes up WFE */
+    while ((NRF_TIMER1->EVENTS_COMPARE[0] == 0) && !delay_interrupted) {
+      __WFE();
+    }
+    if (!sevonpend)
+      SCB->SCR &= ~SCB_SCR_SEVONPEND_Msk;
+
+    while ((NRF_TIMER1->EVENTS_COMPARE[1] == 0) && !delay_interrupted) {
+    }
+
+    if (!delay_interrupted) {
+      delay_timer_release();
+      return;
+    }
+    /* TIMER1 was stopped and possibly reset in the meantime, arm it again with the rest of the delay */
+    us = delay_remaining_us;
   }
+  nrfx_coredep_delay_us(us);
+}
 
-  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+void riotee_delay_ms(unsigned int ms) {
+  /* Limit a single delay to 1000s to stay within the range of the timer */
+  while (ms > 0) {
+    unsigned int chunk = (ms > 1000000) ? 1000000 : ms;
+    riotee_delay_us(chunk * 1000);
+    ms -= chunk;
+  }
 }
 
 int riotee_sleep_ticks(unsigned int ticks) {
   unsigned long notification_value;
-  taskENTER_CRITICAL();
-  xTaskNotifyStateClearIndexed(usr_task_handle, 1);
-  NRF_RTC0->CC[0] = (NRF_RTC0->COUNTER + ticks) % (1 << 24);
-
-  NRF_RTC0->EVENTS_COMPARE[0] = 0;
-  NRF_RTC0->EVTENSET = RTC_EVTENSET_COMPARE0_Msk;
-  NRF_RTC0->INTENSET = RTC_INTENSET_COMPARE0_Msk;
+  /* Timer lives on the stack of the calling task and is always stopped before returning */
+  riotee_timer_t timer;
 
+  riotee_timer_init_notify(&timer, xTaskGetCurrentTaskHandle(), EVT_RTC);
+  taskENTER_CRITICAL();
+  xTaskNotifyStateClearIndexed(NULL, 1);
+  riotee_timer_start(&timer, ticks, 0);
   taskEXIT_CRITICAL();
+
   xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+  /* Sleep may have been interrupted, e.g. by a reset */
+  riotee_timer_stop(&timer);
   if (notification_value != EVT_RTC)
-    return 0;
-  return -1;
+    return -1;
+  return 0;
 }
 
 int riotee_sleep_ms(unsigned int ms) {
@@ -62,18 +129,110 @@ int riotee_sleep_ms(unsigned int ms) {
   return riotee_sleep_ticks((ms * 33554UL) >> 10);
 }
 
+static riotee_timer_t sys_timer;
+
 void sys_setup_timer(unsigned int ticks) {
-  NRF_RTC0->CC[1] = (NRF_RTC0->COUNTER + ticks) % (1 << 24);
-  NRF_RTC0->EVENTS_COMPARE[1] = 0;
-  NRF_RTC0->EVTENSET = RTC_EVTENSET_COMPARE1_Msk;
-  NRF_RTC0->INTENSET = RTC_INTENSET_COMPARE1_Msk;
+  riotee_timer_init_notify(&sys_timer, sys_task_handle, EVT_RTC);
+  riotee_timer_start(&sys_timer, ticks, 0);
 }
 
 void sys_cancel_timer(void) {
-  NRF_RTC0->EVTENCLR = RTC_EVTENSET_COMPARE1_Msk;
-  NRF_RTC0->INTENCLR = RTC_INTENCLR_COMPARE1_Msk;
+  riotee_timer_stop(&sys_timer);
+}
+
+typedef struct {
+  /* Value of riotee_time_now() when the last checkpoint was taken */
+  uint64_t ticks;
+  /* AM1805 timestamp of the last checkpoint in hundredths of a second */
+  uint64_t rtc_hundredths;
+  bool rtc_valid;
+  bool use_am1805;
+} time_checkpoint_t;
+
+/* Part of every checkpoint */
+static time_checkpoint_t time_ckpt __attribute__((section(".retained_bss")));
+/* Difference between riotee_time_now() and the RTC0 based timer that restarts after every reset */
+static uint64_t time_offset;
+
+uint64_t riotee_time_now(void) {
+  return time_offset + riotee_timer_now();
+}
 
-  NRF_RTC0->EVENTS_COMPARE[1] = 0;
+void riotee_time_use_am1805(bool enable) {
+  time_ckpt.use_am1805 = enable;
+}
+
+/* Gets called by the runtime right before the retained memory is written to NVM */
+void sys_time_checkpoint(void) {
+  time_ckpt.ticks = riotee_time_now();
+  time_ckpt.rtc_valid = time_ckpt.use_am1805 && (am1805_get_timestamp(&time_ckpt.rtc_hundredths) == 0);
+}
+
+/* Gets called by the runtime after a checkpoint was restored */
+void sys_time_restore(void) {
+  uint64_t rtc_now;
+  uint64_t since_boot = riotee_timer_now();
+  /* Without an external clock, the time the device was off is lost */
+  uint64_t now = time_ckpt.ticks + since_boot;
+
+  if (time_ckpt.rtc_valid && (am1805_get_timestamp(&rtc_now) == 0) && (rtc_now > time_ckpt.rtc_hundredths)) {
+    /* External clock covers everything since the checkpoint, including the time since this boot */
+    uint64_t elapsed = (rtc_now - time_ckpt.rtc_hundredths) * 32768 / 100;
+    if (time_ckpt.ticks + elapsed > now)
+      now = time_ckpt.ticks + elapsed;
+  }
+  time_offset = now - since_boot;
+}
+
+int riotee_sleep_until(uint64_t deadline) {
+  unsigned long notification_value;
+  riotee_timer_t timer;
+
+  /* deadline lives on the stack of the calling task and is part of the checkpoint */
+  for (;;) {
+    riotee_timer_init_notify(&timer, xTaskGetCurrentTaskHandle(), EVT_RTC);
+    taskENTER_CRITICAL();
+    if (riotee_time_now() >= deadline) {
+      taskEXIT_CRITICAL();
+      return 0;
+    }
+    xTaskNotifyStateClearIndexed(NULL, 1);
+    /* Convert to the time base of the timer, which restarts after every reset */
+    riotee_timer_start_at(&timer, deadline - time_offset, 0);
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyWaitIndexed(1, 0xFFFFFFFF, 0xFFFFFFFF, &notification_value, portMAX_DELAY);
+    riotee_timer_stop(&timer);
+    if (notification_value == EVT_RTC)
+      return 0;
+    /* After a reset, the time offset has been restored and the remaining time is slept */
+    if (notification_value != EVT_RESET)
+      return -1;
+  }
+}
+
+int riotee_sleep_periodic(uint64_t *next, uint32_t period) {
+  int rc;
+
+  if ((rc = riotee_sleep_until(*next)) != 0)
+    return rc;
+
+  *next += period;
+  /* Skip periods that were missed, e.g. while the device was off, without losing the phase */
+  uint64_t now = riotee_time_now();
+  if ((period > 0) && (*next <= now))
+    *next += ((now - *next) / period + 1) * period;
+  return 0;
+}
+
+static void delay_timer_init(void) {
+  NRF_TIMER1->MODE = TIMER_MODE_MODE_Timer << TIMER_MODE_MODE_Pos;
+  NRF_TIMER1->BITMODE = TIMER_BITMODE_BITMODE_32Bit << TIMER_BITMODE_BITMODE_Pos;
+  /* 1us period */
+  NRF_TIMER1->PRESCALER = 4;
+  /* Stop at the end of the delay */
+  NRF_TIMER1->SHORTS = TIMER_SHORTS_COMPARE1_STOP_Msk;
+  NVIC_DisableIRQ(TIMER1_IRQn);
 }
 
 int riotee_timing_init(void) {
@@ -81,10 +240,11 @@ int riotee_timing_init(void) {
 
   NRF_CLOCK->TASKS_LFCLKSTART = 1;
 
-  NVIC_EnableIRQ(RTC0_IRQn);
-
   NRF_RTC0->PRESCALER = 0;
   NRF_RTC0->TASKS_CLEAR = 1;
   NRF_RTC0->TASKS_START = 1;
+
+  riotee_timer_init();
+  delay_timer_init();
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <string.h>
+
+#include "riotee_tscomp.h"
+
+static int put_bits(riotee_tscomp_t *enc, uint32_t value, unsigned int n) {
+  if (enc->n_bits + n > enc->size * 8)
+    return TSCOMP_ERR_FULL;
+
+  while (n > 0) {
+    size_t idx = enc->n_bits >> 3;
+    unsigned int n_free = 8 - (enc->n_bits & 7);
+    unsigned int n_take = (n < n_free) ? n : n_free;
+    uint8_t chunk = (value >> (n - n_take)) & ((1UL << n_take) - 1);
+    /* Clears stale bits from a value that did not fit */
+    uint8_t keep = (n_free == 8) ? 0 : (enc->buf[idx] & (uint8_t)(0xFF << n_free));
+    enc->buf[idx] = keep | (chunk << (n_free - n_take));
+    enc->n_bits += n_take;
+    n -= n_take;
+  }
+  return TSCOMP_ERR_OK;
+}
+
+static int put_zigzag(riotee_tscomp_t *enc, int32_t value) {
+  uint32_t zz = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  int rc;
+
+  if (zz == 0)
+    return put_bits(enc, 0x0, 1);
+  if (zz < (1UL << 7))
+    rc = put_bits(enc, 0x2, 2) || put_bits(enc, zz, 7);
+  else if (zz < (1UL << 9))
+    rc = put_bits(enc, 0x6, 3) || put_bits(enc, zz, 9);
+  else if (zz < (1UL << 12))
+    rc = put_bits(enc, 0xE, 4) || put_bits(enc, zz, 12);
+  else
+    rc = put_bits(enc, 0xF, 4) || put_bits(enc, zz, 32);
+  return rc ? TSCOMP_ERR_FULL : TSCOMP_ERR_OK;
+}
+
+static int put_xor(riotee_tscomp_t *enc, uint32_t x) {
+  if (x == 0)
+    return put_bits(enc, 0x0, 1);
+
+  unsigned int leading = __builtin_clz(x);
+  unsigned int trailing = __builtin_ctz(x);
+
+  /* Reuse the previous window if the meaningful bits fit into it */
+  if ((enc->length > 0) && (leading >= enc->leading) && (trailing >= 32U - enc->leading - enc->length)) {
+    if (put_bits(enc, 0x2, 2) || put_bits(enc, x >> (32 - enc->leading - enc->length), enc->length))
+      return TSCOMP_ERR_FULL;
+    return TSCOMP_ERR_OK;
+  }
+
+  unsigned int length = 32 - leading - trailing;
+  if (put_bits(enc, 0x3, 2) || put_bits(enc, leading, 5) || put_bits(enc, length - 1, 5) ||
+      put_bits(enc, x >> trailing, length))
+    return TSCOMP_ERR_FULL;
+  enc->leading = leading;
+  enc->length = length;
+  return TSCOMP_ERR_OK;
+}
+
+int riotee_tscomp_init(riotee_tscomp_t *enc, riotee_tscomp_codec_t codec, uint8_t *buf, size_t size) {
+  if ((size < RIOTEE_TSCOMP_HEADER_SIZE) || (codec < RIOTEE_TSCOMP_DELTA) || (codec > RIOTEE_TSCOMP_XOR))
+    return TSCOMP_ERR_GENERIC;
+
+  memset(enc, 0, sizeof(riotee_tscomp_t));
+  enc->buf = buf;
+  enc->size = size;
+  enc->codec = codec;
+  enc->n_bits = RIOTEE_TSCOMP_HEADER_SIZE * 8;
+  return TSCOMP_ERR_OK;
+}
+
+/* Encodes with the state of enc and only commits the new state if the value fits */
+static int put(riotee_tscomp_t *enc, uint32_t value) {
+  riotee_tscomp_t next = *enc;
+  int rc;
+
+  if (enc->count >= RIOTEE_TSCOMP_MAX_VALUES)
+    return TSCOMP_ERR_FULL;
+
+  if (enc->count == 0) {
+    rc = put_bits(&next, value, 32);
+  } else if (enc->codec == RIOTEE_TSCOMP_XOR) {
+    rc = put_xor(&next, value ^ enc->prev);
+  } else {
+    uint32_t delta = value - enc->prev;
+    if ((enc->codec == RIOTEE_TSCOMP_DOD) && (enc->count > 1))
+      rc = put_zigzag(&next, (int32_t)(delta - enc->prev_delta));
+    else
+      rc = put_zigzag(&next, (int32_t)delta);
+    next.prev_delta = delta;
+  }
+  if (rc != TSCOMP_ERR_OK)
+    return rc;
+
+  next.prev = value;
+  next.count++;
+  *enc = next;
+  return TSCOMP_ERR_OK;
+}
+
+int riotee_tscomp_put_int(riotee_tscomp_t *enc, int32_t value) {
+  if (enc->codec == RIOTEE_TSCOMP_XOR)
+    return TSCOMP_ERR_GENERIC;
+  return put(enc, (uint32_t)value);
+}
+
+int riotee_tscomp_put_float(riotee_tscomp_t *enc, float value) {
+  uint32_t bits;
+
+  if (enc->codec != RIOTEE_TSCOMP_XOR)
+    return TSCOMP_ERR_GENERIC;
+  memcpy(&bits, &value, sizeof(bits));
+  return put(enc, bits);
+}
+
+size_t riotee_tscomp_finish(riotee_tscomp_t *enc) {
+  enc->buf[0] = enc->codec;
+  enc->buf[1] = enc->count & 0xFF;
+  enc->buf[2] = enc->count >> 8;
+  return (enc->n_bits + 7) / 8;
+}
+
+int riotee_tscomp_codec(const uint8_t *buf, size_t size) {
+  if ((size < RIOTEE_TSCOMP_HEADER_SIZE) || (buf[0] < RIOTEE_TSCOMP_DELTA) || (buf[0] > RIOTEE_TSCOMP_XOR))
+    return TSCOMP_ERR_GENERIC;
+  return buf[0];
+}
+
+typedef struct {
+  const uint8_t *buf;
+  size_t size;
+  size_t n_bits;
+  /* Set when reading past the end */
+  int error;
+} reader_t;
+
+static uint32_t get_bits(reader_t *rd, unsigned int n) {
+  uint32_t value = 0;
+
+  if (rd->n_bits + n > rd->size * 8) {
+    rd->error = TSCOMP_ERR_GENERIC;
+    return 0;
+  }
+  for (unsigned int i = 0; i < n; i++) {
+    value = (value << 1) | ((rd->buf[rd->n_bits >> 3] >> (7 - (rd->n_bits & 7))) & 1);
+    rd->n_bits++;
+  }
+  return value;
+}
+
+static int32_t get_zigzag(reader_t *rd) {
+  uint32_t zz;
+
+  if (get_bits(rd, 1) == 0)
+    return 0;
+  if (get_bits(rd, 1) == 0)
+    zz = get_bits(rd, 7);
+  else if (get_bits(rd, 1) == 0)
+    zz = get_bits(rd, 9);
+  else if (get_bits(rd, 1) == 0)
+    zz = get_bits(rd, 12);
+  else
+    zz = get_bits(rd, 32);
+  return (int32_t)((zz >> 1) ^ (0 - (zz & 1)));
+}
+
+/* Decodes into raw 32 bit patterns. dst is written with memcpy, so it may hold int32_t or float. */
+static int decode(void *dst, size_t n_max, const uint8_t *buf, size_t size, size_t *n_bytes) {
+  int codec = riotee_tscomp_codec(buf, size);
+  if (codec < 0)
+    return TSCOMP_ERR_GENERIC;
+
+  unsigned int count = buf[1] | (buf[2] << 8);
+  if (count > n_max)
+    return TSCOMP_ERR_GENERIC;
+
+  reader_t rd = {.buf = buf, .size = size, .n_bits = RIOTEE_TSCOMP_HEADER_SIZE * 8, .error = 0};
+  uint32_t prev = 0, prev_delta = 0;
+  unsigned int leading = 0, length = 0;
+
+  for (unsigned int i = 0; i < count; i++) {
+    uint32_t value;
+    if (i == 0) {
+      value = get_bits(&rd, 32);
+    } else if (codec == RIOTEE_TSCOMP_XOR) {
+      uint32_t x = 0;
+      if (get_bits(&rd, 1) == 1) {
+        if (get_bits(&rd, 1) == 1) {
+          leading = get_bits(&rd, 5);
+          length = get_bits(&rd, 5) + 1;
+          if (leading + length > 32)
+            return TSCOMP_ERR_GENERIC;
+        } else if (length == 0) {
+          return TSCOMP_ERR_GENERIC;
+        }
+        x = get_bits(&rd, length) << (32 - leading - length);
+      }
+      value = prev ^ x;
+    } else {
+      uint32_t delta = (uint32_t)get_zigzag(&rd);
+      if ((codec == RIOTEE_TSCOMP_DOD) && (i > 1))
+        delta += prev_delta;
+      prev_delta = delta;
+      value = prev + delta;
+    }
+    if (rd.error)
+      return TSCOMP_ERR_GENERIC;
+    memcpy((uint8_t *)dst + i * sizeof(value), &value, sizeof(value));
+    prev = value;
+  }
+
+  if (n_bytes != NULL)
+    *n_bytes = (rd.n_bits + 7) / 8;
+  return count;
+}
+
+int riotee_tscomp_decode_int(int32_t *dst, size_t n_max, const uint8_t *buf, size_t size, size_t *n_bytes) {
+  if (riotee_tscomp_codec(buf, size) == RIOTEE_TSCOMP_XOR)
+    return TSCOMP_ERR_GENERIC;
+  return decode(dst, n_max, buf, size, n_bytes);
+}
+
+int riotee_tscomp_decode_float(float *dst, size_t n_max, const uint8_t *buf, size_t size, size_t *n_bytes) {
+  if (riotee_tscomp_codec(buf, size) != RIOTEE_TSCOMP_XOR)
+    return TSCOMP_ERR_GENERIC;
+  return decode(dst, n_max, buf, size, n_bytes);
+}
@@ -0,0 +1,288 @@
+/* Host test for riotee_progress.h.
+ *
+ * A checkpoint is taken with fork(): the child keeps running like the device after the checkpoint, the parent keeps
+ * the stack and retained memory of the checkpoint. When the child loses power, the parent resumes with the restore
+ * sequence of the runtime. The NVM lives in shared memory, so commits of the child survive like on the device.
+ *
+ * Build and run with 'make test'.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "riotee_nvm.h"
+#include "riotee_progress.h"
+
+#define NVM_SIZE (1 << 20)
+#define N_ITER 8
+
+void sys_progress_restore(void);
+int sys_progress_reset(void);
+
+typedef struct {
+  uint8_t mem[NVM_SIZE];
+  uint32_t addr;
+  bool ready;
+  /* Number of times the body of every iteration ran to its end */
+  unsigned int n_done[N_ITER];
+} shared_t;
+
+static shared_t *shared;
+static int n_failed;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+      n_failed++;                                                     \
+    }                                                                 \
+  } while (0)
+
+int nvm_start(nvm_transfer_type_t transfer_type, uint32_t address) {
+  (void)transfer_type;
+  if (!shared->ready || (address >= NVM_SIZE))
+    return -1;
+  shared->addr = address;
+  return 0;
+}
+
+static int nvm_transfer(uint8_t *dst, const uint8_t *src, size_t size) {
+  if (!shared->ready || (shared->addr + size > NVM_SIZE))
+    return -1;
+  memcpy(dst, src, size);
+  shared->addr += size;
+  return 0;
+}
+
+int nvm_write(uint8_t *src, size_t size) {
+  return nvm_transfer(&shared->mem[shared->addr], src, size);
+}
+
+int nvm_read(uint8_t *dst, size_t size) {
+  return nvm_transfer(dst, &shared->mem[shared->addr], size);
+}
+
+int nvm_stop(void) {
+  return 0;
+}
+
+/* Takes a checkpoint in iteration k, lets iteration k commit and loses power in iteration k + 1 */
+static void test_restore_after_commit(unsigned int k) {
+  static riotee_progress_t progress;
+  bool checkpointed = false;
+  pid_t pid = -1;
+
+  memset(shared->n_done, 0, sizeof(shared->n_done));
+  sys_progress_reset();
+
+  RIOTEE_PROGRESS_FOR(&progress, i, N_ITER) {
+    if ((i == k) && !checkpointed) {
+      checkpointed = true;
+      if ((pid = fork()) < 0) {
+        perror("fork");
+        exit(1);
+      }
+      if (pid > 0) {
+        int status;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+        sys_progress_restore();
+      }
+    }
+    if ((i == k + 1) && (pid == 0))
+      _exit(0);
+    shared->n_done[i]++;
+  }
+
+  CHECK(riotee_progress_get(&progress) == N_ITER);
+  for (unsigned int i = 0; i < N_ITER; i++)
+    CHECK(shared->n_done[i] >= 1);
+  /* The rest of iteration k runs again after the restore, nothing else is repeated */
+  CHECK(shared->n_done[k] == 2);
+}
+
+/* Takes a checkpoint in iteration k and loses power in the last iteration. The loop fills a retained buffer that the
+ * restore rolls back to iteration k. */
+static void test_bound_data(unsigned int k) {
+  static riotee_progress_t progress;
+  static uint32_t out[N_ITER];
+  bool checkpointed = false;
+  pid_t pid = -1;
+
+  sys_progress_reset();
+  CHECK(riotee_progress_bind(&progress, out, sizeof(out)) == PROGRESS_ERR_OK);
+
+  RIOTEE_PROGRESS_FOR(&progress, i, N_ITER) {
+    if ((i == k) && !checkpointed) {
+      checkpointed = true;
+      if ((pid = fork()) < 0) {
+        perror("fork");
+        exit(1);
+      }
+      if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        sys_progress_restore();
+      }
+    }
+    if ((i == N_ITER - 1) && (pid == 0))
+      _exit(0);
+    out[i] = 100 + i;
+  }
+
+  for (unsigned int i = 0; i < N_ITER; i++)
+    CHECK(out[i] == 100 + i);
+}
+
+enum { TASK_A = 0, TASK_B, TASK_C, TASK_D };
+
+typedef struct {
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  /* Checkpoint is taken in task a, power fails in task d */
+  bool checkpointed;
+  pid_t pid;
+} graph_ctx_t;
+
+static graph_ctx_t graph_ctx;
+
+static uint32_t task_a(void *ctx) {
+  graph_ctx_t *g = ctx;
+  if (!g->checkpointed) {
+    g->checkpointed = true;
+    if ((g->pid = fork()) < 0) {
+      perror("fork");
+      exit(1);
+    }
+    if (g->pid > 0) {
+      waitpid(g->pid, NULL, 0);
+      sys_progress_restore();
+    }
+  }
+  /* Resumes after the restore on the context of a later commit, this write must not survive */
+  g->a = 1;
+  g->b = 0;
+  return TASK_B;
+}
+
+static uint32_t task_b(void *ctx) {
+  graph_ctx_t *g = ctx;
+  g->b = g->a + 1;
+  return TASK_C;
+}
+
+static uint32_t task_c(void *ctx) {
+  graph_ctx_t *g = ctx;
+  g->c = g->b + 1;
+  return TASK_D;
+}
+
+static uint32_t task_d(void *ctx) {
+  graph_ctx_t *g = ctx;
+  if (g->pid == 0)
+    _exit(0);
+  CHECK((g->a == 1) && (g->b == 2) && (g->c == 3));
+  return RIOTEE_TASK_DONE;
+}
+
+/* Several transitions commit between the checkpoint and the power failure */
+static void test_task_graph_ctx(unsigned int unused) {
+  static riotee_progress_t progress;
+  static const riotee_task_fn_t tasks[] = {task_a, task_b, task_c, task_d};
+
+  (void)unused;
+
+  sys_progress_reset();
+  CHECK(riotee_task_graph_run(&progress, tasks, 4, &graph_ctx, sizeof(graph_ctx)) == PROGRESS_ERR_OK);
+  CHECK(riotee_progress_get(&progress) == (1UL << 16));
+}
+
+/* A counter without a slot or without NVM still finishes its loop */
+static void test_loop_without_commit(unsigned int unused) {
+  static riotee_progress_t taken[RIOTEE_PROGRESS_N_SLOTS];
+  static riotee_progress_t progress;
+  unsigned int n_runs = 0;
+
+  (void)unused;
+
+  sys_progress_reset();
+  for (unsigned int i = 0; i < RIOTEE_PROGRESS_N_SLOTS; i++)
+    CHECK(riotee_progress_attach(&taken[i]) == PROGRESS_ERR_OK);
+  CHECK(riotee_progress_attach(&progress) == PROGRESS_ERR_FULL);
+  RIOTEE_PROGRESS_FOR(&progress, i, N_ITER) {
+    CHECK(i == n_runs);
+    if (n_runs++ > N_ITER)
+      break;
+  }
+  CHECK(n_runs == N_ITER);
+
+  n_runs = 0;
+  shared->ready = false;
+  RIOTEE_PROGRESS_FOR(&taken[0], i, N_ITER) {
+    CHECK(i == n_runs);
+    if (n_runs++ > N_ITER)
+      break;
+  }
+  shared->ready = true;
+  CHECK(n_runs == N_ITER);
+  CHECK(riotee_progress_get(&taken[0]) == N_ITER);
+}
+
+static void test_nvm_not_ready(unsigned int unused) {
+  static riotee_progress_t progress;
+  static riotee_progress_t late;
+
+  (void)unused;
+
+  sys_progress_reset();
+  CHECK(riotee_progress_commit(&progress, 3) == PROGRESS_ERR_OK);
+
+  shared->ready = false;
+  CHECK(riotee_progress_commit(&progress, 4) == PROGRESS_ERR_GENERIC);
+  CHECK(riotee_progress_get(&progress) == 3);
+  shared->ready = true;
+
+  /* The log is cleared on the next attach if the NVM was not ready during the reset */
+  shared->ready = false;
+  CHECK(sys_progress_reset() != 0);
+  shared->ready = true;
+  CHECK(riotee_progress_attach(&late) == PROGRESS_ERR_OK);
+  CHECK(riotee_progress_get(&late) == 0);
+}
+
+/* Runs a test in its own process, so that it starts with the zeroed retained memory of a fresh device */
+static void run(void (*test)(unsigned int), unsigned int arg) {
+  pid_t pid = fork();
+  int status;
+
+  if (pid == 0) {
+    test(arg);
+    _exit(n_failed ? 1 : 0);
+  }
+  if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    n_failed++;
+}
+
+int main(void) {
+  shared = mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  shared->ready = true;
+
+  for (unsigned int k = 0; k < N_ITER - 1; k++) {
+    run(test_restore_after_commit, k);
+    run(test_bound_data, k);
+  }
+  run(test_task_graph_ctx, 0);
+  run(test_loop_without_commit, 0);
+  run(test_nvm_not_ready, 0);
+
+  printf("progress_test: %s\n", n_failed ? "FAILED" : "OK");
+  return n_failed ? 1 : 0;
+}
@@ -0,0 +1,5 @@
+/* Host stand-in for the FreeRTOS headers used by the hardware-independent sources under test */
+#ifndef __STUB_FREERTOS_H_
+#define __STUB_FREERTOS_H_
+
+#endif /* __STUB_FREERTOS_H_ */
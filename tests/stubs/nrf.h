@@ -0,0 +1,4 @@
+#ifndef __STUB_NRF_H_
+#define __STUB_NRF_H_
+
+#endif /* __STUB_NRF_H_ */
@@ -0,0 +1,8 @@
+#ifndef __STUB_TASK_H_
+#define __STUB_TASK_H_
+
+/* The tests are single-threaded */
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif /* __STUB_TASK_H_ */
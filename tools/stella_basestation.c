@@ -0,0 +1,218 @@
+/* Host stand-in for a Stella basestation.
+ *
+ * Receives encoded uplink packets as UDP datagrams, one packet per datagram, and answers every valid packet with an
+ * acknowledgement built by riotee_stella_build_ack(). Packets are parsed with the same codec that is compiled into the
+ * firmware. Together with stella_loadgen this allows testing basestation software and protocol changes without radio
+ * hardware.
+ *
+ * Build with 'make tools' and run '_build/tools/stella_basestation -h' for a list of parameters.
+ */
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "riotee_stella_codec.h"
+
+/* Number of devices for which the last packet ID is remembered to detect retransmissions */
+#define N_DEVICES_MAX 1024
+
+typedef struct {
+  const char *addr;
+  unsigned int port;
+  /* Probability of not sending an acknowledgement for a valid packet */
+  double ack_drop;
+  /* Delay between reception of an uplink and transmission of the acknowledgement */
+  unsigned int turnaround_us;
+  /* Statistics are printed in this interval. 0 disables statistics. */
+  unsigned int stats_interval_s;
+  bool verbose;
+  uint64_t seed;
+} bs_cfg_t;
+
+typedef struct {
+  unsigned long received;
+  unsigned long malformed;
+  unsigned long duplicates;
+  unsigned long acked;
+  unsigned long ack_dropped;
+  unsigned long payload_bytes;
+} bs_stats_t;
+
+typedef struct {
+  uint32_t dev_id;
+  uint16_t last_pkt_id;
+} device_t;
+
+static bs_cfg_t cfg = {.addr = "127.0.0.1", .port = 5500, .stats_interval_s = 1, .seed = 1};
+
+static bs_stats_t stats;
+static device_t devices[N_DEVICES_MAX];
+static unsigned int n_devices;
+static uint64_t rng_state;
+
+static double rand_uniform(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double time_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns true if pkt is a retransmission of the last packet received from the same device */
+static bool is_duplicate(const riotee_stella_pkt_t *pkt) {
+  for (unsigned int i = 0; i < n_devices; i++) {
+    if (devices[i].dev_id == pkt->hdr.dev_id) {
+      bool dup = (devices[i].last_pkt_id == pkt->hdr.pkt_id);
+      devices[i].last_pkt_id = pkt->hdr.pkt_id;
+      return dup;
+    }
+  }
+  if (n_devices < N_DEVICES_MAX)
+    devices[n_devices++] = (device_t){.dev_id = pkt->hdr.dev_id, .last_pkt_id = pkt->hdr.pkt_id};
+  return false;
+}
+
+static void print_stats(double t) {
+  printf("t=%.1f devices=%u received=%lu malformed=%lu duplicates=%lu acked=%lu ack_dropped=%lu payload_bytes=%lu\n", t,
+         n_devices, stats.received, stats.malformed, stats.duplicates, stats.acked, stats.ack_dropped,
+         stats.payload_bytes);
+  fflush(stdout);
+}
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options]\n", prog);
+  printf("  -a ADDR  address to listen on (default %s)\n", cfg.addr);
+  printf("  -p PORT  UDP port to listen on (default %u)\n", cfg.port);
+  printf("  -d PROB  probability of not acknowledging a valid packet (default %.2f)\n", cfg.ack_drop);
+  printf("  -t US    turnaround delay before sending the acknowledgement (default %u)\n", cfg.turnaround_us);
+  printf("  -i S     statistics interval in seconds, 0 to disable (default %u)\n", cfg.stats_interval_s);
+  printf("  -s SEED  random seed (default %lu)\n", (unsigned long)cfg.seed);
+  printf("  -v       print every packet\n");
+  printf("  -h       show this help\n");
+}
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "a:p:d:t:i:s:vh")) != -1) {
+    switch (opt) {
+      case 'a':
+        cfg.addr = optarg;
+        break;
+      case 'p':
+        cfg.port = strtoul(optarg, NULL, 0);
+        break;
+      case 'd':
+        cfg.ack_drop = strtod(optarg, NULL);
+        break;
+      case 't':
+        cfg.turnaround_us = strtoul(optarg, NULL, 0);
+        break;
+      case 'i':
+        cfg.stats_interval_s = strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        cfg.seed = strtoull(optarg, NULL, 0);
+        break;
+      case 'v':
+        cfg.verbose = true;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  rng_state = cfg.seed ? cfg.seed : 1;
+
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) {
+    perror("socket");
+    return 1;
+  }
+
+  struct sockaddr_in local = {.sin_family = AF_INET, .sin_port = htons(cfg.port)};
+  if (inet_pton(AF_INET, cfg.addr, &local.sin_addr) != 1) {
+    fprintf(stderr, "Invalid address %s\n", cfg.addr);
+    return 1;
+  }
+  if (bind(sock, (struct sockaddr *)&local, sizeof(local)) < 0) {
+    perror("bind");
+    return 1;
+  }
+
+  /* Wake up regularly to print statistics even if no packets arrive */
+  struct timeval tv = {.tv_sec = 0, .tv_usec = 100000};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  printf("Listening on %s:%u\n", cfg.addr, cfg.port);
+  fflush(stdout);
+
+  double t_start = time_now();
+  double t_stats = t_start + cfg.stats_interval_s;
+  uint16_t pkt_counter = 0;
+
+  for (;;) {
+    uint8_t frame[STELLA_MAX_FRAME];
+    struct sockaddr_in remote;
+    socklen_t remote_len = sizeof(remote);
+
+    ssize_t n = recvfrom(sock, frame, sizeof(frame), 0, (struct sockaddr *)&remote, &remote_len);
+
+    if (cfg.stats_interval_s && (time_now() >= t_stats)) {
+      print_stats(time_now() - t_start);
+      t_stats += cfg.stats_interval_s;
+    }
+
+    if (n <= 0)
+      continue;
+
+    riotee_stella_pkt_t ul;
+    stats.received++;
+    if (riotee_stella_decode(&ul, frame, n) != STELLA_ERR_OK) {
+      stats.malformed++;
+      continue;
+    }
+
+    int n_payload = riotee_stella_pkt_payload_len(&ul);
+    stats.payload_bytes += n_payload;
+    if (is_duplicate(&ul))
+      stats.duplicates++;
+
+    if (cfg.verbose)
+      printf("RX dev=%08X pkt=%u ack=%u len=%d\n", ul.hdr.dev_id, ul.hdr.pkt_id, ul.hdr.ack_id, n_payload);
+
+    if (rand_uniform() < cfg.ack_drop) {
+      stats.ack_dropped++;
+      continue;
+    }
+
+    riotee_stella_pkt_t ack;
+    riotee_stella_build_ack(&ack, &ul, pkt_counter++, NULL, 0);
+    if ((n = riotee_stella_encode(frame, sizeof(frame), &ack)) < 0)
+      continue;
+
+    if (cfg.turnaround_us)
+      usleep(cfg.turnaround_us);
+
+    if (sendto(sock, frame, n, 0, (struct sockaddr *)&remote, remote_len) == n)
+      stats.acked++;
+  }
+
+  return 0;
+}
@@ -0,0 +1,327 @@
+/* Load generator for a Stella basestation.
+ *
+ * Emulates a number of devices that send encoded uplink packets as UDP datagrams to a basestation, e.g.
+ * stella_basestation. Each device waits for the acknowledgement like riotee_stella_transceive() and validates it with
+ * riotee_stella_check_ack(). Packets without a valid acknowledgement are retransmitted up to a configurable number of
+ * times. Acknowledgement latency is reported in total and, with -v, per device.
+ *
+ * Build with 'make tools' and run '_build/tools/stella_loadgen -h' for a list of parameters.
+ */
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "riotee_stella_codec.h"
+
+typedef struct {
+  const char *addr;
+  unsigned int port;
+  unsigned int n_devices;
+  /* Mean time between two new uplink packets of a device */
+  double interval_ms;
+  unsigned int payload;
+  /* Time to wait for an acknowledgement. The radio only waits STELLA_ACK_TIMEOUT_US, but network latency on the
+   * host is much larger. */
+  double timeout_ms;
+  unsigned int max_retries;
+  double duration_s;
+  uint64_t seed;
+  bool per_device;
+} lg_cfg_t;
+
+typedef struct {
+  int sock;
+  uint32_t dev_id;
+  uint16_t pkt_counter;
+  riotee_stella_pkt_t tx_pkt;
+  unsigned int attempt;
+  bool waiting;
+  double t_next;
+  double t_sent;
+  /* Start of the first transmission attempt of the current packet */
+  double t_first;
+  unsigned long delivered;
+  unsigned long dropped;
+  /* Latency of delivered packets in microseconds */
+  double lat_min;
+  double lat_max;
+  double lat_sum;
+} device_t;
+
+typedef struct {
+  unsigned long sent;
+  unsigned long attempts;
+  unsigned long delivered;
+  unsigned long dropped;
+  unsigned long timeouts;
+  unsigned long wrong_ack;
+} lg_stats_t;
+
+static lg_cfg_t cfg = {.addr = "127.0.0.1",
+                       .port = 5500,
+                       .n_devices = 10,
+                       .interval_ms = 100.0,
+                       .payload = 16,
+                       .timeout_ms = 50.0,
+                       .max_retries = 3,
+                       .duration_s = 10.0,
+                       .seed = 1,
+                       .per_device = false};
+
+static lg_stats_t stats;
+static uint64_t rng_state;
+
+/* Latencies of all delivered packets in microseconds */
+static double *latencies;
+static size_t latencies_len, latencies_cap;
+
+static double rand_uniform(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rand_exp(double mean) {
+  return -mean * log(1.0 - rand_uniform());
+}
+
+static double time_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void latency_add(double us) {
+  if (latencies_len == latencies_cap) {
+    latencies_cap = latencies_cap ? 2 * latencies_cap : 1024;
+    latencies = realloc(latencies, latencies_cap * sizeof(double));
+  }
+  latencies[latencies_len++] = us;
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void device_send(device_t *dev, const struct sockaddr_in *remote, double now) {
+  uint8_t frame[STELLA_MAX_FRAME];
+
+  if (dev->attempt == 0) {
+    uint8_t data[STELLA_MAX_PAYLOAD];
+    for (unsigned int i = 0; i < cfg.payload; i++)
+      data[i] = rand_uniform() * 256;
+    riotee_stella_pkt_build(&dev->tx_pkt, dev->dev_id, dev->pkt_counter++, 0, data, cfg.payload);
+    dev->t_first = now;
+    stats.sent++;
+  }
+
+  int n = riotee_stella_encode(frame, sizeof(frame), &dev->tx_pkt);
+  sendto(dev->sock, frame, n, 0, (const struct sockaddr *)remote, sizeof(*remote));
+  stats.attempts++;
+  dev->t_sent = now;
+  dev->waiting = true;
+}
+
+/* Ends the current transaction with the return code that riotee_stella_transceive() would produce */
+static void device_finish(device_t *dev, int rc, double now) {
+  dev->waiting = false;
+  if (rc == STELLA_ERR_OK) {
+    double us = (now - dev->t_first) * 1e6;
+    stats.delivered++;
+    latency_add(us);
+    if ((dev->delivered == 0) || (us < dev->lat_min))
+      dev->lat_min = us;
+    if (us > dev->lat_max)
+      dev->lat_max = us;
+    dev->lat_sum += us;
+    dev->delivered++;
+    dev->attempt = 0;
+    dev->t_next = now + rand_exp(cfg.interval_ms * 1e-3);
+    return;
+  }
+
+  if (dev->attempt < cfg.max_retries) {
+    dev->attempt++;
+    dev->t_next = now;
+  } else {
+    stats.dropped++;
+    dev->dropped++;
+    dev->attempt = 0;
+    dev->t_next = now + rand_exp(cfg.interval_ms * 1e-3);
+  }
+}
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options]\n", prog);
+  printf("  -a ADDR  basestation address (default %s)\n", cfg.addr);
+  printf("  -p PORT  basestation UDP port (default %u)\n", cfg.port);
+  printf("  -n N     number of emulated devices (default %u)\n", cfg.n_devices);
+  printf("  -i MS    mean interval between packets of a device (default %.1f)\n", cfg.interval_ms);
+  printf("  -l N     payload bytes per packet (default %u)\n", cfg.payload);
+  printf("  -w MS    acknowledgement timeout (default %.1f)\n", cfg.timeout_ms);
+  printf("  -r N     maximum number of retransmissions (default %u)\n", cfg.max_retries);
+  printf("  -t S     duration in seconds (default %.1f)\n", cfg.duration_s);
+  printf("  -s SEED  random seed (default %lu)\n", (unsigned long)cfg.seed);
+  printf("  -v       also print delivery and latency statistics per device\n");
+  printf("  -h       show this help\n");
+}
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "a:p:n:i:l:w:r:t:s:vh")) != -1) {
+    switch (opt) {
+      case 'a':
+        cfg.addr = optarg;
+        break;
+      case 'p':
+        cfg.port = strtoul(optarg, NULL, 0);
+        break;
+      case 'n':
+        cfg.n_devices = strtoul(optarg, NULL, 0);
+        break;
+      case 'i':
+        cfg.interval_ms = strtod(optarg, NULL);
+        break;
+      case 'l':
+        cfg.payload = strtoul(optarg, NULL, 0);
+        break;
+      case 'w':
+        cfg.timeout_ms = strtod(optarg, NULL);
+        break;
+      case 'r':
+        cfg.max_retries = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        cfg.duration_s = strtod(optarg, NULL);
+        break;
+      case 's':
+        cfg.seed = strtoull(optarg, NULL, 0);
+        break;
+      case 'v':
+        cfg.per_device = true;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  rng_state = cfg.seed ? cfg.seed : 1;
+
+  if (cfg.payload > STELLA_MAX_PAYLOAD) {
+    fprintf(stderr, "Payload must not exceed %zu bytes\n", STELLA_MAX_PAYLOAD);
+    return 1;
+  }
+  if (cfg.n_devices == 0) {
+    fprintf(stderr, "Need at least one device\n");
+    return 1;
+  }
+
+  struct sockaddr_in remote = {.sin_family = AF_INET, .sin_port = htons(cfg.port)};
+  if (inet_pton(AF_INET, cfg.addr, &remote.sin_addr) != 1) {
+    fprintf(stderr, "Invalid address %s\n", cfg.addr);
+    return 1;
+  }
+
+  /* Every device has its own socket, so acknowledgements are delivered to the right device */
+  device_t *devices = calloc(cfg.n_devices, sizeof(device_t));
+  struct pollfd *pfds = calloc(cfg.n_devices, sizeof(struct pollfd));
+  double t_start = time_now();
+  for (unsigned int i = 0; i < cfg.n_devices; i++) {
+    if ((devices[i].sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+      perror("socket");
+      return 1;
+    }
+    devices[i].dev_id = 0x10000000 + i;
+    devices[i].t_next = t_start + rand_exp(cfg.interval_ms * 1e-3);
+    pfds[i].fd = devices[i].sock;
+    pfds[i].events = POLLIN;
+  }
+
+  double now;
+  while ((now = time_now()) < t_start + cfg.duration_s) {
+    /* Sleep until the next device is due, at most 1ms */
+    double t_wake = now + 1e-3;
+    for (unsigned int i = 0; i < cfg.n_devices; i++) {
+      device_t *dev = &devices[i];
+      double t = dev->waiting ? dev->t_sent + cfg.timeout_ms * 1e-3 : dev->t_next;
+      if (t < t_wake)
+        t_wake = t;
+    }
+    int timeout = (t_wake > now) ? (int)ceil((t_wake - now) * 1e3) : 0;
+    poll(pfds, cfg.n_devices, timeout);
+
+    now = time_now();
+    for (unsigned int i = 0; i < cfg.n_devices; i++) {
+      device_t *dev = &devices[i];
+
+      if (pfds[i].revents & POLLIN) {
+        uint8_t frame[STELLA_MAX_FRAME];
+        riotee_stella_pkt_t ack;
+        ssize_t n = recv(dev->sock, frame, sizeof(frame), 0);
+        /* Late acknowledgements of a previous attempt are ignored like on the radio */
+        if (dev->waiting && (n > 0)) {
+          int rc = riotee_stella_decode(&ack, frame, n);
+          if (rc == STELLA_ERR_OK)
+            rc = riotee_stella_check_ack(&ack, &dev->tx_pkt);
+          if (rc != STELLA_ERR_OK)
+            stats.wrong_ack++;
+          device_finish(dev, rc, now);
+        }
+      }
+
+      if (dev->waiting && (now >= dev->t_sent + cfg.timeout_ms * 1e-3)) {
+        stats.timeouts++;
+        device_finish(dev, STELLA_ERR_NOACK, now);
+      }
+
+      if (!dev->waiting && (now >= dev->t_next))
+        device_send(dev, &remote, now);
+    }
+  }
+
+  double lat_min = 0, lat_avg = 0, lat_max = 0, lat_p99 = 0;
+  if (latencies_len > 0) {
+    qsort(latencies, latencies_len, sizeof(double), cmp_double);
+    for (size_t i = 0; i < latencies_len; i++)
+      lat_avg += latencies[i];
+    lat_avg /= latencies_len;
+    lat_min = latencies[0];
+    lat_max = latencies[latencies_len - 1];
+    lat_p99 = latencies[(size_t)(0.99 * (latencies_len - 1))];
+  }
+
+  printf("devices=%u sent=%lu attempts=%lu delivered=%lu dropped=%lu timeouts=%lu wrong_ack=%lu\n", cfg.n_devices,
+         stats.sent, stats.attempts, stats.delivered, stats.dropped, stats.timeouts, stats.wrong_ack);
+  printf("latency_us min=%.0f avg=%.0f p99=%.0f max=%.0f\n", lat_min, lat_avg, lat_p99, lat_max);
+
+  if (cfg.per_device) {
+    for (unsigned int i = 0; i < cfg.n_devices; i++) {
+      device_t *dev = &devices[i];
+      printf("device=%08X delivered=%lu dropped=%lu latency_us min=%.0f avg=%.0f max=%.0f\n", dev->dev_id,
+             dev->delivered, dev->dropped, dev->lat_min, dev->delivered ? dev->lat_sum / dev->delivered : 0.0,
+             dev->lat_max);
+    }
+  }
+
+  for (unsigned int i = 0; i < cfg.n_devices; i++)
+    close(devices[i].sock);
+  free(devices);
+  free(pfds);
+  free(latencies);
+  return 0;
+}
@@ -0,0 +1,480 @@
+/* Discrete-event simulation of many Riotee nodes sharing a single Stella channel with one basestation.
+ *
+ * Every node runs the transaction sequence of riotee_stella_transceive(): HFXO startup, uplink transmission, radio
+ * turnaround and a STELLA_ACK_TIMEOUT_US window for the address of the acknowledgement. Received acknowledgements are
+ * validated with riotee_stella_check_ack() from the firmware. All nodes and the basestation are in one collision
+ * domain: any overlap of two transmissions corrupts both of them.
+ *
+ * Build with 'make tools' and run '_build/tools/stella_sim -h' for a list of parameters.
+ */
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riotee_stella_codec.h"
+
+/* Duration of one byte on air with 1MBit/s */
+#define T_BYTE_US 8
+/* Fast radio ramp-up, see nRF52833 PS */
+#define RADIO_RAMPUP_US 40
+/* 1B preamble, 2B base address, 1B prefix, 1B length field, 3B CRC */
+#define FRAME_OVERHEAD_BYTES 8
+/* Bytes on air until the ADDRESS event fires */
+#define ADDRESS_BYTES 4
+
+typedef struct {
+  unsigned int n_nodes;
+  unsigned int n_nodes_max;
+  unsigned int n_nodes_step;
+  double duration_s;
+  /* Mean time between two new uplink packets of a node */
+  double interval_ms;
+  /* Number of user bytes per uplink packet */
+  unsigned int payload;
+  /* Probability of losing a packet that did not collide */
+  double ul_loss;
+  double dl_loss;
+  /* Number of retransmissions before a packet is dropped */
+  unsigned int max_retries;
+  /* Retransmissions are delayed by a random time up to this value */
+  double backoff_ms;
+  unsigned int hfxo_us;
+  /* Time between end of uplink and start of acknowledgement at the basestation */
+  unsigned int bs_turnaround_us;
+  uint64_t seed;
+} sim_cfg_t;
+
+typedef enum { EV_WAKE, EV_TX_START, EV_TX_END, EV_RX_READY, EV_RX_TIMEOUT, EV_ACK_START } ev_type_t;
+
+typedef struct {
+  uint64_t t;
+  ev_type_t type;
+  unsigned int idx;
+  /* Transaction sequence number to discard events of transactions that are already finished */
+  unsigned int seq;
+} event_t;
+
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+  /* Index of the sending node or -1 for the basestation */
+  int src;
+  bool corrupted;
+  riotee_stella_pkt_t pkt;
+} transmission_t;
+
+typedef enum { NODE_IDLE, NODE_HFXO, NODE_TX, NODE_RAMPUP, NODE_RX } node_state_t;
+
+typedef struct {
+  node_state_t state;
+  unsigned int seq;
+  riotee_stella_pkt_t tx_pkt;
+  riotee_stella_pkt_t rx_pkt;
+  uint16_t pkt_counter;
+  unsigned int attempt;
+  uint64_t rx_timeout_t;
+  /* Transmission the receiver has locked onto or -1 */
+  int rx_tx;
+  uint64_t on_since;
+} node_t;
+
+typedef struct {
+  unsigned long generated;
+  unsigned long attempts;
+  unsigned long delivered;
+  unsigned long dropped;
+  unsigned long collisions;
+  unsigned long wrong_ack;
+  unsigned long bs_missed;
+  uint64_t radio_on_us;
+  uint64_t channel_busy_us;
+} sim_stats_t;
+
+static sim_cfg_t cfg = {.n_nodes = 100,
+                        .duration_s = 60.0,
+                        .interval_ms = 1000.0,
+                        .payload = 16,
+                        .ul_loss = 0.01,
+                        .dl_loss = 0.01,
+                        .max_retries = 3,
+                        .backoff_ms = 10.0,
+                        .hfxo_us = 300,
+                        .bs_turnaround_us = 60,
+                        .seed = 1};
+
+static event_t *heap;
+static size_t heap_len, heap_cap;
+
+static transmission_t *txs;
+static size_t txs_len, txs_cap;
+
+/* Indices of transmissions currently on air */
+static int *active;
+static size_t active_len;
+
+static node_t *nodes;
+static sim_stats_t stats;
+
+static struct {
+  bool busy;
+  /* Uplink the basestation is currently receiving or -1 */
+  int rx_tx;
+  uint16_t pkt_counter;
+} bs;
+
+static uint64_t now;
+static uint64_t rng_state;
+static uint64_t busy_since;
+
+static double rand_uniform(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rand_exp(double mean) {
+  return -mean * log(1.0 - rand_uniform());
+}
+
+static void heap_push(uint64_t t, ev_type_t type, unsigned int idx, unsigned int seq) {
+  if (heap_len == heap_cap) {
+    heap_cap = heap_cap ? 2 * heap_cap : 1024;
+    heap = realloc(heap, heap_cap * sizeof(event_t));
+  }
+  size_t i = heap_len++;
+  while (i > 0 && heap[(i - 1) / 2].t > t) {
+    heap[i] = heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap[i] = (event_t){.t = t, .type = type, .idx = idx, .seq = seq};
+}
+
+static event_t heap_pop(void) {
+  event_t top = heap[0];
+  event_t last = heap[--heap_len];
+  size_t i = 0;
+  for (;;) {
+    size_t c = 2 * i + 1;
+    if (c >= heap_len)
+      break;
+    if (c + 1 < heap_len && heap[c + 1].t < heap[c].t)
+      c++;
+    if (heap[c].t >= last.t)
+      break;
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = last;
+  return top;
+}
+
+static unsigned int airtime_us(const riotee_stella_pkt_t *pkt) {
+  return (FRAME_OVERHEAD_BYTES + pkt->len) * T_BYTE_US;
+}
+
+/* Puts a new transmission on air and returns its index */
+static int channel_start(int src, const riotee_stella_pkt_t *pkt) {
+  if (txs_len == txs_cap) {
+    txs_cap = txs_cap ? 2 * txs_cap : 1024;
+    txs = realloc(txs, txs_cap * sizeof(transmission_t));
+  }
+  int idx = txs_len++;
+  transmission_t *tx = &txs[idx];
+  tx->start = now;
+  tx->end = now + airtime_us(pkt);
+  tx->src = src;
+  tx->corrupted = false;
+  memcpy(&tx->pkt, pkt, pkt->len + 1);
+
+  if (active_len > 0) {
+    tx->corrupted = true;
+    for (size_t i = 0; i < active_len; i++)
+      txs[active[i]].corrupted = true;
+  } else {
+    busy_since = now;
+  }
+  active[active_len++] = idx;
+  return idx;
+}
+
+static void channel_end(int idx) {
+  for (size_t i = 0; i < active_len; i++) {
+    if (active[i] == idx) {
+      active[i] = active[--active_len];
+      break;
+    }
+  }
+  if (active_len == 0)
+    stats.channel_busy_us += now - busy_since;
+}
+
+static void node_schedule_next(unsigned int idx) {
+  node_t *node = &nodes[idx];
+  if (node->attempt > 0)
+    heap_push(now + (uint64_t)(rand_uniform() * cfg.backoff_ms * 1000.0), EV_WAKE, idx, node->seq);
+  else
+    heap_push(now + (uint64_t)rand_exp(cfg.interval_ms * 1000.0), EV_WAKE, idx, node->seq);
+}
+
+/* Ends the current transaction with the return code that riotee_stella_transceive() would produce */
+static void node_finish(unsigned int idx, int rc) {
+  node_t *node = &nodes[idx];
+
+  stats.radio_on_us += now - node->on_since;
+  node->state = NODE_IDLE;
+  node->rx_tx = -1;
+  node->seq++;
+
+  if (rc == STELLA_ERR_OK) {
+    stats.delivered++;
+    node->attempt = 0;
+  } else {
+    if (rc == STELLA_ERR_GENERIC)
+      stats.wrong_ack++;
+    if (node->attempt < cfg.max_retries) {
+      node->attempt++;
+    } else {
+      stats.dropped++;
+      node->attempt = 0;
+    }
+  }
+  node_schedule_next(idx);
+}
+
+static void handle_event(event_t *ev) {
+  node_t *node = (ev->type != EV_TX_END && ev->type != EV_ACK_START) ? &nodes[ev->idx] : NULL;
+
+  if ((node != NULL) && (ev->seq != node->seq))
+    return;
+
+  switch (ev->type) {
+    case EV_WAKE:
+      /* New packet or retransmission of the previous one */
+      if (node->attempt == 0) {
+        node->tx_pkt.len = sizeof(riotee_stella_pkt_header_t) + cfg.payload;
+        node->tx_pkt.hdr.pkt_id = node->pkt_counter++;
+        stats.generated++;
+      }
+      node->state = NODE_HFXO;
+      node->on_since = now;
+      heap_push(now + cfg.hfxo_us + RADIO_RAMPUP_US, EV_TX_START, ev->idx, node->seq);
+      break;
+
+    case EV_TX_START: {
+      node->state = NODE_TX;
+      stats.attempts++;
+      int tx = channel_start(ev->idx, &node->tx_pkt);
+      if (!bs.busy && bs.rx_tx < 0)
+        bs.rx_tx = tx;
+      else
+        stats.bs_missed++;
+      heap_push(txs[tx].end, EV_TX_END, tx, 0);
+      break;
+    }
+
+    case EV_TX_END: {
+      transmission_t *tx = &txs[ev->idx];
+      channel_end(ev->idx);
+
+      if (tx->src >= 0) {
+        /* Uplink: node switches to reception via DISABLED->RXEN short */
+        node_t *src = &nodes[tx->src];
+        src->state = NODE_RAMPUP;
+        heap_push(now + RADIO_RAMPUP_US, EV_RX_READY, tx->src, src->seq);
+
+        if (tx->corrupted)
+          stats.collisions++;
+
+        if (bs.rx_tx == (int)ev->idx) {
+          bs.rx_tx = -1;
+          if (!tx->corrupted && (rand_uniform() >= cfg.ul_loss)) {
+            bs.busy = true;
+            heap_push(now + cfg.bs_turnaround_us, EV_ACK_START, ev->idx, 0);
+          }
+        }
+      } else {
+        /* Acknowledgement: all nodes that locked onto it get CRCOK or CRCERROR */
+        bs.busy = false;
+        for (unsigned int i = 0; i < cfg.n_nodes; i++) {
+          node_t *rcv = &nodes[i];
+          if ((rcv->state != NODE_RX) || (rcv->rx_tx != (int)ev->idx))
+            continue;
+          if (tx->corrupted || (rand_uniform() < cfg.dl_loss)) {
+            node_finish(i, STELLA_ERR_NOACK);
+          } else {
+            memcpy(&rcv->rx_pkt, &tx->pkt, tx->pkt.len + 1);
+            node_finish(i, riotee_stella_check_ack(&rcv->rx_pkt, &rcv->tx_pkt));
+          }
+        }
+      }
+      break;
+    }
+
+    case EV_ACK_START: {
+      riotee_stella_pkt_t ack;
+      const riotee_stella_pkt_t *ul = &txs[ev->idx].pkt;
+
+      riotee_stella_build_ack(&ack, ul, bs.pkt_counter++, NULL, 0);
+
+      int tx = channel_start(-1, &ack);
+      heap_push(txs[tx].end, EV_TX_END, tx, 0);
+
+      /* Every node waiting for an acknowledgement locks onto it if the address arrives before its timeout */
+      for (unsigned int i = 0; i < cfg.n_nodes; i++) {
+        node_t *rcv = &nodes[i];
+        if ((rcv->state == NODE_RX) && (rcv->rx_tx < 0) && (now + ADDRESS_BYTES * T_BYTE_US < rcv->rx_timeout_t))
+          rcv->rx_tx = tx;
+      }
+      break;
+    }
+
+    case EV_RX_READY:
+      node->state = NODE_RX;
+      node->rx_tx = -1;
+      node->rx_timeout_t = now + STELLA_ACK_TIMEOUT_US;
+      heap_push(node->rx_timeout_t, EV_RX_TIMEOUT, ev->idx, node->seq);
+      break;
+
+    case EV_RX_TIMEOUT:
+      if (node->rx_tx < 0)
+        node_finish(ev->idx, STELLA_ERR_NOACK);
+      break;
+  }
+}
+
+static void run(unsigned int n_nodes) {
+  uint64_t t_end = (uint64_t)(cfg.duration_s * 1e6);
+
+  cfg.n_nodes = n_nodes;
+  memset(&stats, 0, sizeof(stats));
+  heap_len = txs_len = active_len = 0;
+  now = 0;
+  rng_state = cfg.seed * 0x9E3779B97F4A7C15ULL + n_nodes;
+  bs.busy = false;
+  bs.rx_tx = -1;
+  bs.pkt_counter = 0;
+
+  nodes = calloc(n_nodes, sizeof(node_t));
+  active = calloc(n_nodes + 1, sizeof(int));
+
+  for (unsigned int i = 0; i < n_nodes; i++) {
+    nodes[i].tx_pkt.hdr.dev_id = 0x10000000 + i;
+    nodes[i].pkt_counter = rand_uniform() * 65536;
+    nodes[i].rx_tx = -1;
+    node_schedule_next(i);
+  }
+
+  while (heap_len > 0) {
+    event_t ev = heap_pop();
+    if (ev.t > t_end)
+      break;
+    now = ev.t;
+    handle_event(&ev);
+  }
+
+  double goodput_bps = stats.delivered * cfg.payload * 8 / cfg.duration_s;
+  double pdr = (stats.delivered + stats.dropped) ? (double)stats.delivered / (stats.delivered + stats.dropped) : 0.0;
+  double attempts_per_pkt = stats.delivered ? (double)stats.attempts / stats.delivered : 0.0;
+  double on_us_per_pkt = stats.delivered ? (double)stats.radio_on_us / stats.delivered : 0.0;
+
+  printf("%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.1f,%.4f,%.3f,%.1f,%.4f\n", n_nodes, stats.generated, stats.attempts,
+         stats.delivered, stats.dropped, stats.collisions, stats.wrong_ack, stats.bs_missed, goodput_bps, pdr,
+         attempts_per_pkt, on_us_per_pkt, stats.channel_busy_us / (cfg.duration_s * 1e6));
+
+  free(nodes);
+  free(active);
+}
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options]\n", prog);
+  printf("  -n NODES    number of nodes (default %u)\n", cfg.n_nodes);
+  printf("  -N NODES    sweep number of nodes from -n up to this value\n");
+  printf("  -S STEP     step size of the sweep (default 10)\n");
+  printf("  -t SECONDS  simulated time (default %.0f)\n", cfg.duration_s);
+  printf("  -i MS       mean interval between new packets per node (default %.0f)\n", cfg.interval_ms);
+  printf("  -p BYTES    payload size (default %u)\n", cfg.payload);
+  printf("  -u PROB     uplink loss probability (default %.2f)\n", cfg.ul_loss);
+  printf("  -d PROB     downlink loss probability (default %.2f)\n", cfg.dl_loss);
+  printf("  -r N        maximum number of retransmissions (default %u)\n", cfg.max_retries);
+  printf("  -b MS       maximum random backoff before a retransmission (default %.0f)\n", cfg.backoff_ms);
+  printf("  -x US       HFXO startup time (default %u)\n", cfg.hfxo_us);
+  printf("  -a US       basestation turnaround time (default %u)\n", cfg.bs_turnaround_us);
+  printf("  -s SEED     random seed (default %lu)\n", (unsigned long)cfg.seed);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  cfg.n_nodes_step = 10;
+  while ((opt = getopt(argc, argv, "n:N:S:t:i:p:u:d:r:b:x:a:s:h")) != -1) {
+    switch (opt) {
+      case 'n':
+        cfg.n_nodes = strtoul(optarg, NULL, 0);
+        break;
+      case 'N':
+        cfg.n_nodes_max = strtoul(optarg, NULL, 0);
+        break;
+      case 'S':
+        cfg.n_nodes_step = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        cfg.duration_s = strtod(optarg, NULL);
+        break;
+      case 'i':
+        cfg.interval_ms = strtod(optarg, NULL);
+        break;
+      case 'p':
+        cfg.payload = strtoul(optarg, NULL, 0);
+        break;
+      case 'u':
+        cfg.ul_loss = strtod(optarg, NULL);
+        break;
+      case 'd':
+        cfg.dl_loss = strtod(optarg, NULL);
+        break;
+      case 'r':
+        cfg.max_retries = strtoul(optarg, NULL, 0);
+        break;
+      case 'b':
+        cfg.backoff_ms = strtod(optarg, NULL);
+        break;
+      case 'x':
+        cfg.hfxo_us = strtoul(optarg, NULL, 0);
+        break;
+      case 'a':
+        cfg.bs_turnaround_us = strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        cfg.seed = strtoull(optarg, NULL, 0);
+        break;
+      default:
+        usage(argv[0]);
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  if (cfg.payload > STELLA_MAX_PAYLOAD) {
+    fprintf(stderr, "Payload must not exceed %zu bytes\n", STELLA_MAX_PAYLOAD);
+    return 1;
+  }
+  if ((cfg.n_nodes == 0) || (cfg.n_nodes_step == 0)) {
+    fprintf(stderr, "Number of nodes and step size must be positive\n");
+    return 1;
+  }
+  if (cfg.n_nodes_max < cfg.n_nodes)
+    cfg.n_nodes_max = cfg.n_nodes;
+
+  printf("nodes,generated,attempts,delivered,dropped,collisions,wrong_ack,bs_missed,goodput_bps,pdr,"
+         "attempts_per_pkt,radio_on_us_per_pkt,channel_util\n");
+  for (unsigned int n = cfg.n_nodes; n <= cfg.n_nodes_max; n += cfg.n_nodes_step)
+    run(n);
+
+  free(heap);
+  free(txs);
+  return 0;
+}
@@ -0,0 +1,257 @@
+/* Host decoder for blocks produced by riotee_tscomp.h.
+ *
+ * Reads blocks from a file or stdin, either raw binary as read back from NVM or as hex text as logged by a
+ * basestation, and prints one CSV line per value. Blocks may follow each other directly or sit in fixed-size records,
+ * e.g. Stella payloads or NVM ring entries, with padding behind every block. The same codec is compiled into the
+ * firmware.
+ *
+ * With -e, the tool works the other way round and packs values from the input, one per line, into blocks. This shows
+ * how many readings of a real trace fit into one payload.
+ *
+ * Build with 'make tools' and run '_build/tools/tscomp_decode -h' for a list of parameters.
+ */
+#include <ctype.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riotee_tscomp.h"
+
+typedef struct {
+  const char *path;
+  bool hex;
+  /* Size of the records that hold one block each or 0 if blocks follow each other directly */
+  size_t record_size;
+  /* Codec for encoding or 0 for decoding */
+  int encode_codec;
+} decode_cfg_t;
+
+static decode_cfg_t cfg = {.path = NULL, .hex = false, .record_size = 0, .encode_codec = 0};
+
+static uint8_t *read_input(FILE *f, size_t *size) {
+  size_t cap = 4096, n = 0;
+  uint8_t *buf = malloc(cap);
+  int c, nibble = -1;
+
+  while (buf != NULL && (c = fgetc(f)) != EOF) {
+    if (n == cap) {
+      uint8_t *tmp = realloc(buf, cap *= 2);
+      if (tmp == NULL) {
+        free(buf);
+        return NULL;
+      }
+      buf = tmp;
+    }
+    if (!cfg.hex) {
+      buf[n++] = c;
+      continue;
+    }
+    if (!isxdigit(c))
+      continue;
+    int v = isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+    if (nibble < 0) {
+      nibble = v;
+    } else {
+      buf[n++] = (nibble << 4) | v;
+      nibble = -1;
+    }
+  }
+  *size = n;
+  return buf;
+}
+
+static int decode_all(const uint8_t *buf, size_t size) {
+  static union {
+    int32_t i[RIOTEE_TSCOMP_MAX_VALUES];
+    float f[RIOTEE_TSCOMP_MAX_VALUES];
+  } values;
+  unsigned long n_values = 0, n_blocks = 0;
+  size_t pos = 0;
+
+  printf("block,index,value\n");
+  while (pos + RIOTEE_TSCOMP_HEADER_SIZE <= size) {
+    size_t avail = cfg.record_size ? cfg.record_size : size - pos;
+    size_t n_bytes;
+    int codec, n;
+
+    if (avail > size - pos)
+      avail = size - pos;
+    if ((codec = riotee_tscomp_codec(&buf[pos], avail)) < 0) {
+      /* Unused records in an NVM ring are erased or zero */
+      if (cfg.record_size) {
+        pos += cfg.record_size;
+        continue;
+      }
+      fprintf(stderr, "Invalid block at offset %zu\n", pos);
+      return 1;
+    }
+
+    if (codec == RIOTEE_TSCOMP_XOR)
+      n = riotee_tscomp_decode_float(values.f, RIOTEE_TSCOMP_MAX_VALUES, &buf[pos], avail, &n_bytes);
+    else
+      n = riotee_tscomp_decode_int(values.i, RIOTEE_TSCOMP_MAX_VALUES, &buf[pos], avail, &n_bytes);
+    if (n < 0) {
+      fprintf(stderr, "Truncated or corrupt block at offset %zu\n", pos);
+      return 1;
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (codec == RIOTEE_TSCOMP_XOR)
+        printf("%lu,%d,%.9g\n", n_blocks, i, values.f[i]);
+      else
+        printf("%lu,%d,%d\n", n_blocks, i, values.i[i]);
+    }
+    n_values += n;
+    n_blocks++;
+    pos += cfg.record_size ? cfg.record_size : n_bytes;
+  }
+
+  fprintf(stderr, "blocks=%lu values=%lu bytes=%zu bits_per_value=%.2f\n", n_blocks, n_values, pos,
+          n_values ? 8.0 * pos / n_values : 0.0);
+  return 0;
+}
+
+static void print_block(riotee_tscomp_t *enc, unsigned long *n_blocks, unsigned long *n_bytes) {
+  size_t n = riotee_tscomp_finish(enc);
+  size_t len = cfg.record_size ? cfg.record_size : n;
+
+  for (size_t i = 0; i < len; i++)
+    printf("%02x", (i < n) ? enc->buf[i] : 0);
+  printf("\n");
+  (*n_blocks)++;
+  *n_bytes += n;
+}
+
+static int encode_all(const char *text) {
+  size_t size = cfg.record_size ? cfg.record_size : 65536;
+  uint8_t *block = malloc(size);
+  unsigned long n_values = 0, n_blocks = 0, n_bytes = 0;
+  riotee_tscomp_t enc;
+  char *end;
+
+  if (block == NULL)
+    return 1;
+  riotee_tscomp_init(&enc, cfg.encode_codec, block, size);
+
+  for (const char *p = text; *p != '\0'; p = end) {
+    int rc;
+    if (cfg.encode_codec == RIOTEE_TSCOMP_XOR) {
+      float v = strtof(p, &end);
+      if (end == p)
+        break;
+      if ((rc = riotee_tscomp_put_float(&enc, v)) == TSCOMP_ERR_FULL) {
+        print_block(&enc, &n_blocks, &n_bytes);
+        riotee_tscomp_init(&enc, cfg.encode_codec, block, size);
+        rc = riotee_tscomp_put_float(&enc, v);
+      }
+    } else {
+      long v = strtol(p, &end, 0);
+      if (end == p)
+        break;
+      if ((rc = riotee_tscomp_put_int(&enc, v)) == TSCOMP_ERR_FULL) {
+        print_block(&enc, &n_blocks, &n_bytes);
+        riotee_tscomp_init(&enc, cfg.encode_codec, block, size);
+        rc = riotee_tscomp_put_int(&enc, v);
+      }
+    }
+    if (rc != TSCOMP_ERR_OK) {
+      fprintf(stderr, "Value does not fit into an empty block\n");
+      free(block);
+      return 1;
+    }
+    n_values++;
+  }
+  if (enc.count > 0)
+    print_block(&enc, &n_blocks, &n_bytes);
+
+  fprintf(stderr, "blocks=%lu values=%lu bytes=%lu bits_per_value=%.2f values_per_block=%.1f\n", n_blocks, n_values,
+          n_bytes, n_values ? 8.0 * n_bytes / n_values : 0.0, n_blocks ? (double)n_values / n_blocks : 0.0);
+  free(block);
+  return 0;
+}
+
+static int parse_codec(const char *name) {
+  if (strcmp(name, "delta") == 0)
+    return RIOTEE_TSCOMP_DELTA;
+  if (strcmp(name, "dod") == 0)
+    return RIOTEE_TSCOMP_DOD;
+  if (strcmp(name, "xor") == 0)
+    return RIOTEE_TSCOMP_XOR;
+  return -1;
+}
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] [FILE]\n", prog);
+  printf("  -x        input is hex text instead of binary\n");
+  printf("  -s SIZE   every block sits in a record of SIZE bytes, e.g. 247 for Stella payloads (default 0)\n");
+  printf("  -e CODEC  encode values from the input instead, CODEC is delta, dod or xor. Prints blocks as hex.\n");
+  printf("  -h        show this help\n");
+}
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "xs:e:h")) != -1) {
+    switch (opt) {
+      case 'x':
+        cfg.hex = true;
+        break;
+      case 's':
+        cfg.record_size = strtoul(optarg, NULL, 0);
+        break;
+      case 'e':
+        if ((cfg.encode_codec = parse_codec(optarg)) < 0) {
+          fprintf(stderr, "Unknown codec %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind < argc)
+    cfg.path = argv[optind];
+  if (cfg.record_size && cfg.record_size < RIOTEE_TSCOMP_HEADER_SIZE) {
+    fprintf(stderr, "Record size must be at least %d\n", RIOTEE_TSCOMP_HEADER_SIZE);
+    return 1;
+  }
+
+  FILE *f = cfg.path ? fopen(cfg.path, cfg.hex || cfg.encode_codec ? "r" : "rb") : stdin;
+  if (f == NULL) {
+    perror(cfg.path);
+    return 1;
+  }
+
+  /* Values for encoding are read as text */
+  if (cfg.encode_codec)
+    cfg.hex = false;
+
+  size_t size;
+  uint8_t *buf = read_input(f, &size);
+  if (f != stdin)
+    fclose(f);
+  /* Room for the terminating zero of the text */
+  uint8_t *tmp = (buf != NULL) ? realloc(buf, size + 1) : NULL;
+  if (tmp == NULL) {
+    free(buf);
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+  buf = tmp;
+
+  int rc;
+  if (cfg.encode_codec) {
+    buf[size] = '\0';
+    rc = encode_all((const char *)buf);
+  } else {
+    rc = decode_all(buf, size);
+  }
+  free(buf);
+  return rc;
+}